@@ -0,0 +1,124 @@
+//
+// Created by Sebastian Sandstig on 2026-10-17.
+//
+
+#ifndef ANALYSISTHREAD_H
+#define ANALYSISTHREAD_H
+
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include <BandMapper.h>
+#include <BeatTracker.h>
+#include <CaptureRing.h>
+#include <MultiResolutionAnalyzer.h>
+#include <MusicChangeDetector.h>
+#include <Resampler.h>
+#include <Stft.h>
+#include <ThreadTuning.h>
+#include <TripleBuffer.h>
+
+// One published analysis result
+struct AnalysisFrame {
+    std::vector<float> magnitudes;      // Normalised magnitudes of the longest STFT, see Stft
+    std::vector<float> band_energies;   // Weighted mean magnitude of each display band, see MultiResolutionAnalyzer
+    uint64_t sample_position = 0;       // Analysis-rate cursor one past the newest sample of the frame
+    double time = 0.0;                  // Seconds of audio since capture started, at the end of the frame
+    BeatState beat;                     // Onsets, tempo and beat phase as of this frame
+    MusicChangeState music;             // Loudness, silence and song changes as of this frame
+    uint64_t sequence = 0;              // Frames published so far, 0 until the first one is
+
+    // Steady clock timeline of the newest audio in the frame, for PipelineLatency
+    std::chrono::steady_clock::time_point capture_time;     // Captured (ADC time when the source knows it)
+    std::chrono::steady_clock::time_point pickup_time;      // Read off the capture ring by the analysis thread
+    std::chrono::steady_clock::time_point publish_time;     // Handed to the renderer
+};
+
+struct AnalysisSettings {
+    size_t analysis_rate = 24000;
+    size_t fft_size = 8192;             // The long transform: the published magnitudes and the bass bands
+    size_t hop_size = 512;
+    // Shorter transforms for the upper bands; empty for a single resolution
+    std::vector<SpectrumResolution> detail_resolutions = {{2048, 256, 250.0f}, {512, 128, 2000.0f}};
+    size_t block_size = 512;            // Capture samples moved through the resampler at a time
+    SpectrumEngine::Kind spectrum_engine = SpectrumEngine::DEFAULT_KIND;
+    Stft::Window window = Stft::HANN;
+    size_t band_count = 16;
+    float band_low_frequency = 30.0f;
+    float band_high_frequency = 10000.0f;
+    BandMapper::Scale band_scale = BandMapper::MEL;
+    ThreadPolicy thread_policy;
+};
+
+// Runs the capture -> resampler -> STFT chain on its own thread so the render loop never pays for an FFT.
+// The thread sleeps on the capture ring and wakes whenever the audio callback writes; each completed hop is
+// published through a triple buffer that the renderer reads with `latest()` without ever waiting.
+class AnalysisThread {
+public:
+    AnalysisThread(const std::shared_ptr<CaptureRing> &capture, size_t capture_rate, const AnalysisSettings &settings);
+    ~AnalysisThread();
+
+    AnalysisThread(const AnalysisThread&) = delete;
+    AnalysisThread& operator=(const AnalysisThread&) = delete;
+
+    void start();
+    void stop();
+    [[nodiscard]] bool running() const { return m_thread.joinable(); }
+
+    // Renderer side: the newest published frame. Only one thread may call this.
+    const AnalysisFrame& latest();
+
+    [[nodiscard]] const Stft& stft() const { return m_analyzer.primary(); }
+    [[nodiscard]] const MultiResolutionAnalyzer& analyzer() const { return m_analyzer; }
+    [[nodiscard]] size_t analysis_rate() const { return m_analysis_rate; }
+    [[nodiscard]] size_t band_count() const { return m_requested_band_count.load(std::memory_order_relaxed); }
+    // Capture samples overwritten before the analysis read them: non-zero means this thread fell a ring behind
+    [[nodiscard]] uint64_t lost_samples() const { return m_lost_samples.load(std::memory_order_relaxed); }
+    // Takes effect from the next published frame; any thread may call it
+    void set_band_count(size_t band_count);
+    // Song changes seen so far (see MusicChangeDetector) and whether it is quiet right now; any thread
+    [[nodiscard]] uint64_t music_changes() const { return m_music_changes.load(std::memory_order_acquire); }
+    [[nodiscard]] bool silent() const { return m_silent.load(std::memory_order_relaxed); }
+    // Called on the analysis thread right after `music_changes()` went up. Set it before start().
+    void on_music_change(std::function<void()> callback) { m_on_music_change = std::move(callback); }
+    // mlocks the buffers the analysis streams through (the resampler blocks and the analysis ring); false if any
+    // was refused
+    bool lock_memory() const;
+private:
+    std::shared_ptr<CaptureRing> m_capture;
+    size_t m_analysis_rate;
+    ThreadPolicy m_thread_policy;
+
+    // Touched only by the analysis thread once started
+    CaptureRing::Reader m_reader;
+    Resampler m_resampler;
+    std::vector<float> m_capture_block;
+    std::vector<float> m_resampled_block;
+    CaptureRing m_analysis_ring;
+    MultiResolutionAnalyzer m_analyzer;
+    BeatTracker m_beats;                // Fed at the long transform's hop rate
+    MusicChangeDetector m_music;        // Likewise
+    uint64_t m_published = 0;
+    std::chrono::steady_clock::time_point m_capture_time;
+    std::chrono::steady_clock::time_point m_pickup_time;
+    std::atomic<size_t> m_requested_band_count;
+    std::atomic<uint64_t> m_lost_samples = 0;
+    std::atomic<uint64_t> m_music_changes = 0;
+    std::atomic<bool> m_silent = true;
+    std::function<void()> m_on_music_change;
+
+    TripleBuffer<AnalysisFrame> m_frames;
+    std::atomic<bool> m_continue;
+    std::thread m_thread;
+
+    void run();
+    // Moves everything the capture reader has through the resampler into the analysis ring
+    void pump();
+    void publish();
+};
+
+#endif //ANALYSISTHREAD_H
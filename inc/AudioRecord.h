@@ -8,107 +8,36 @@
 #define GLM_FORCE_RADIANS
 #define GLM_FORCE_DEPTH_ZERO_TO_ONE
 
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <condition_variable>
 #include <fstream>
+#include <future>
 #include <iostream>
+#include <mutex>
+#include <optional>
+#include <stop_token>
 #include <thread>
 #include <vector>
 
 #include <json.hpp>
-#include <portaudio.h>
 #include <glm/mat4x4.hpp>
 #include <glm/trigonometric.hpp>
 #include <glm/vec4.hpp>
 #include <vibra/vibra.h>
 #include <vibra/communication/shazam.h>
 
-using namespace nlohmann;
-
-struct RecordData {
-    size_t next_sample_index = 0;  /* Index into sample array. */
-    std::vector<float> recorded_samples;
-};
-
-class AudioRecordCallback {
-public:
-    explicit AudioRecordCallback(const size_t buffer_size) {
-        std::lock_guard guard(m_mutex);
-
-        m_record_data = std::make_unique<RecordData>();
-        const auto record_data = m_record_data;
-        record_data->next_sample_index = 0;
-        record_data->recorded_samples.resize(buffer_size);
-
-        m_continue_recording = std::make_unique<bool>();
-        // const auto continue_recording = m_continue_recording;
-        // *continue_recording = true;
-        *m_continue_recording = true;
-    }
-    ~AudioRecordCallback() = default;
-    int callback(const void *input_buffer, void *output_buffer,
-                           const unsigned long frames_per_buffer,
-                           const PaStreamCallbackTimeInfo* time_info,
-                           PaStreamCallbackFlags status_flags)
-    {
-        // auto arc = static_cast<AudioRecordCallback *>(user_data);
-        std::lock_guard<std::mutex> guard(m_mutex);
-
-        const auto *read_ptr = static_cast<const float *>(input_buffer);
-        size_t i;
-
-        const auto record_data = m_record_data;
-        if(input_buffer == nullptr) {
-            for( i=0; i<frames_per_buffer; i++ )
-            {
-                record_data->recorded_samples[record_data->next_sample_index++] = 0.0f;
-                if (record_data->next_sample_index >= record_data->recorded_samples.size()) {
-                    record_data->next_sample_index = 0;
-                }
-            }
-        }
-        else
-        {
-            for(i=0; i<frames_per_buffer; i++) {
-                record_data->recorded_samples[record_data->next_sample_index++] = read_ptr[i];
-                if (record_data->next_sample_index >= record_data->recorded_samples.size()) {
-                    record_data->next_sample_index = 0;
-                }
-            }
-        }
-
-        const auto continue_recording = m_continue_recording;
-        if (*continue_recording)
-            return paContinue;
-
-        return paComplete;
-    }
+#include <AnalysisThread.h>
+#include <AudioSource.h>
+#include <CaptureRing.h>
+#include <PortAudioSource.h>
+#include <RecognitionCache.h>
+#include <SpectrumEngine.h>
+#include <Stft.h>
+#include <ThreadTuning.h>
 
-    void get_buffer(std::vector<float>* output) {
-        std::lock_guard<std::mutex> guard(m_mutex);
-        const auto record_data = m_record_data;
-        // output->insert(output->begin(), record_data->recorded_samples.begin(), record_data->recorded_samples.end());
-        size_t oi = 0;
-        for(size_t i=m_record_data->next_sample_index; i<record_data->recorded_samples.size(); i++) {
-            (*output)[oi++] = record_data->recorded_samples[i];
-        }
-        for(size_t i=0; i<m_record_data->next_sample_index; i++) {
-            (*output)[oi++] = record_data->recorded_samples[i];
-        }
-    }
-    void stop_recording() {
-        std::lock_guard<std::mutex> guard(m_mutex);
-        const auto continue_recording = m_continue_recording;
-        *continue_recording = false;
-    }
-    bool stopped_recording() {
-        std::lock_guard<std::mutex> guard(m_mutex);
-        const auto continue_recording = m_continue_recording;
-        return !*continue_recording;
-    }
-private:
-    std::shared_ptr<RecordData> m_record_data;
-    std::shared_ptr<bool> m_continue_recording;
-    std::mutex m_mutex;
-};
+using namespace nlohmann;
 
 typedef std::array<float, 3 * 5> joe_colors_t;
 
@@ -117,27 +46,42 @@ public:
     RecognizeSong() = default;
     ~RecognizeSong() = default;
 
-    void recognize(const Fingerprint* fp) {
-        m_song_data = json::parse(Shazam::Recognize(fp));
-        std::cout << "Recognize Song Data: " << m_song_data << std::endl;
-        if (!m_song_data.contains("track")) {
+    // Shows `track`, or no cover art if the song was not identified. True if it was.
+    bool recognize(const std::optional<RecognizedTrack> &track) {
+        if (!track.has_value()) {
+            std::cout << "Song not recognised" << std::endl;
             reset_fields();
-            return;
+            return false;
         }
-        auto track = m_song_data["track"];
-
-        std::optional<std::string> cover_art = std::nullopt;
-        std::optional<joe_colors_t> joe_color = std::nullopt;
-        if (track.contains("images")) {
-            if (const auto images = track["images"]; images.contains("coverart")) {
-                cover_art = images["coverart"].template get<std::string>();
-                auto joe_color_string = images["joecolor"].template get<std::string>();
-                joe_color = extract_joe_colors(joe_color_string);
+        std::cout << "Recognised " << track->title << " by " << track->subtitle << " (" << track->key << ")"
+                  << std::endl;
+        m_cover_art = track->cover_art.empty() ? std::nullopt : std::optional(track->cover_art);
+        m_joe_color = track->cover_art.empty() ? std::nullopt : extract_joe_colors(track->joe_color);
+        return true;
+    }
 
-            }
+    // The "track" object of a Shazam response, or nothing if the response is not an identification
+    [[nodiscard]] static std::optional<json> parse_track(const std::string &response) {
+        auto data = json::parse(response, nullptr, false);
+        if (data.is_discarded() || !data.contains("track") || !data["track"].is_object()) return std::nullopt;
+        return std::move(data["track"]);
+    }
+    // What is shown of a track; fields the response lacks are left empty
+    [[nodiscard]] static RecognizedTrack describe_track(const json &track) {
+        const auto text = [](const json &object, const char *name) {
+            const auto field = object.find(name);
+            return field != object.end() && field->is_string() ? field->template get<std::string>() : std::string();
+        };
+        RecognizedTrack recognized {
+            .key = text(track, "key"),
+            .title = text(track, "title"),
+            .subtitle = text(track, "subtitle"),
+        };
+        if (const auto images = track.find("images"); images != track.end() && images->is_object()) {
+            recognized.cover_art = text(*images, "coverart");
+            recognized.joe_color = text(*images, "joecolor");
         }
-        m_joe_color = joe_color;
-        m_cover_art = cover_art;
+        return recognized;
     }
 
     [[nodiscard]] std::optional<std::string> get_cover_art_url() const { return m_cover_art; }
@@ -145,16 +89,14 @@ public:
 
 
 private:
-    basic_json<> m_song_data = json::parse(R"({})");
     std::optional<std::string> m_cover_art;
     std::optional<joe_colors_t> m_joe_color;
 
     void reset_fields() {
-        m_song_data = json::parse(R"({})");
         m_cover_art = std::nullopt;
     }
 
-    [[nodiscard]] static std::optional<joe_colors_t> extract_joe_colors(std::string& raw) {
+    [[nodiscard]] static std::optional<joe_colors_t> extract_joe_colors(const std::string& raw) {
         if (raw.empty()) return std::nullopt;
         joe_colors_t joe_colors {};
 
@@ -184,338 +126,315 @@ private:
     }
 };
 
+struct AudioRecordSettings {
+    size_t sample_rate = 0;         // Capture rate of the default PortAudio source, 0 for the device's native rate
+    size_t analysis_rate = 24000;   // Rate the capture is resampled to before the FFT
+    size_t fft_size = 8192;         // Power of two, bins are analysis_rate / fft_size Hz wide
+    size_t hop_size = 512;          // New analysis samples required before the spectrum is recomputed
+    // Shorter transforms for the upper bands, see MultiResolutionAnalyzer; empty to use fft_size alone
+    std::vector<SpectrumResolution> detail_resolutions = {{2048, 256, 250.0f}, {512, 128, 2000.0f}};
+    size_t frame_size = 512;        // Frames per PortAudio callback
+    SpectrumEngine::Kind spectrum_engine = SpectrumEngine::DEFAULT_KIND;
+    Stft::Window window = Stft::HANN;
+    size_t band_count = 16;         // Display bands published with every spectrum
+    float band_low_frequency = 30.0f;
+    float band_high_frequency = 10000.0f;
+    BandMapper::Scale band_scale = BandMapper::MEL;
+    // Scheduling and CPUs of the source's, the analysis and the recognition thread, and whether to lock the capture
+    // and analysis buffers in memory. The render policy is the caller's to apply.
+    ThreadTuningSettings threads;
+    // Recognised tracks outlive the process here, see RecognitionCache; empty keeps them in memory only
+    std::string recognition_cache_path;
+    size_t recognition_cache_capacity = 256;
+};
+
 class AudioRecord : RecognizeSong {
 public:
-    explicit AudioRecord(const size_t sample_rate = 44100, const size_t frame_size = 512) : RecognizeSong(),
-        m_sample_rate(sample_rate), m_frame_size(frame_size), m_dft_real(m_sample_rate), m_dft_imag(m_sample_rate),
-        m_dft_out(m_sample_rate / 2)
+    // Records from `source`, or from the default input device through PortAudio if none is given
+    explicit AudioRecord(const AudioRecordSettings &settings = {}, std::unique_ptr<AudioSource> source = nullptr)
+        : RecognizeSong(),
+        m_source(source != nullptr ? std::move(source) : std::make_unique<PortAudioSource>(settings.sample_rate)),
+        m_sample_rate(m_source->sample_rate()), m_analysis_rate(settings.analysis_rate), m_fft_size(settings.fft_size),
+        m_hop_size(settings.hop_size), m_frame_size(settings.frame_size),
+        m_recognition_thread_policy(settings.threads.recognition),
+        m_recognition_cache(settings.recognition_cache_capacity, settings.recognition_cache_path),
+        m_is_alive(m_source->is_alive())
     {
-        m_err = Pa_Initialize();
-        if(m_err != paNoError) {
-            m_is_alive = false;
-            return;
-        }
-
-        m_input_parameters = {};
-        m_input_parameters.device = Pa_GetDefaultInputDevice(); /* default input device */
-        if (m_input_parameters.device == paNoDevice) {
-            fprintf(stderr,"Error: No default input device.\n");
-            m_is_alive = false;
-            return;
+        m_source->set_thread_policy(settings.threads.audio);
+        // The recognizer fingerprints straight out of the ring, which leaves it at least a second of writes, less the
+        // block being written, before they reach its window
+        m_ring = std::make_shared<CaptureRing>(m_sample_rate * CAPTURE_RING_SECONDS,
+                                               m_sample_rate * RECOGNITION_WINDOW_SECONDS.back());
+        m_analysis = std::make_unique<AnalysisThread>(m_ring, m_sample_rate, AnalysisSettings {
+            .analysis_rate = m_analysis_rate,
+            .fft_size = m_fft_size,
+            .hop_size = m_hop_size,
+            .detail_resolutions = settings.detail_resolutions,
+            .block_size = m_frame_size,
+            .spectrum_engine = settings.spectrum_engine,
+            .window = settings.window,
+            .band_count = settings.band_count,
+            .band_low_frequency = settings.band_low_frequency,
+            .band_high_frequency = settings.band_high_frequency,
+            .band_scale = settings.band_scale,
+            .thread_policy = settings.threads.dsp,
+        });
+        if (settings.threads.lock_memory) {
+            ThreadTuning::lock_memory("capture ring", m_ring->memory());
+            m_analysis->lock_memory();
         }
-        m_input_parameters.channelCount = 1;
-        m_input_parameters.sampleFormat = paFloat32;
-        m_input_parameters.suggestedLatency = Pa_GetDeviceInfo(m_input_parameters.device)->defaultLowInputLatency;
-        m_input_parameters.hostApiSpecificStreamInfo = nullptr;
+        m_analysis->on_music_change([this] {
+            // Taking the lock orders the change before the recognizer's check of it, so the wake is not lost
+            { std::lock_guard<std::mutex> guard(m_recognition_wake_mutex); }
+            m_recognition_wake.notify_all();
+        });
     }
     ~AudioRecord() {
         stop_recording();
         stop_recognition();
-        Pa_Terminate();
-        if(m_err != paNoError)
-        {
-            fprintf( stderr, "An error occurred while using the portaudio stream\n" );
-            fprintf( stderr, "Error number: %d\n", m_err );
-            fprintf( stderr, "Error message: %s\n", Pa_GetErrorText( m_err ) );
-            m_err = 1;          /* Always return 0 or 1, but no other return codes. */
-        }
-        delete m_arc;
     }
 
     [[nodiscard]] bool start_recording() {
         if(!m_is_alive) return false;
-        if (m_recording_thread != nullptr) return true;
-        delete m_arc;
-        m_arc = new AudioRecordCallback(m_sample_rate);
-        m_recording_thread = new std::thread(auxiliary_start_recording, m_stream, &m_input_parameters,
-                                             static_cast<double>(m_sample_rate),
-                                             m_frame_size,
-                                             m_arc);
+        if (!m_source->start(m_ring, m_frame_size)) return false;
+        m_analysis->start();
 
         return m_is_alive;
     }
-    [[nodiscard]] bool is_active() {
-        if(!m_is_alive) return false;
-
-        m_err = Pa_IsStreamActive(m_stream);
-        if (m_err < 0) {
-            m_is_alive = false;
-            return false;
-        }
-
-        return true;
-    }
+    [[nodiscard]] bool is_active() const { return m_is_alive && m_source->is_active(); }
     [[nodiscard]] bool stop_recording() {
         if(!m_is_alive) return false;
 
-        if (m_arc != nullptr) {
-            m_arc->stop_recording();
-        }
-
-        if (m_recording_thread != nullptr) {
-            m_recording_thread->join();
-            delete m_recording_thread;
-            m_recording_thread = nullptr;
-        }
+        m_source->stop();
+        m_analysis->stop();
 
         return m_is_alive;
     }
     [[nodiscard]] bool is_alive() const { return m_is_alive; }
     [[nodiscard]] std::vector<float> recorded_data() const {
         std::vector<float> recorded_samples;
-        if (m_arc != nullptr) {
+        if (m_source->is_active()) {
             recorded_samples.resize(m_sample_rate);
-            m_arc->get_buffer(&recorded_samples);
+            // A torn copy means the source lapped us mid-read, the next try sees a consistent ring
+            while (!m_ring->read_latest(recorded_samples.data(), recorded_samples.size())) {}
         }
         return recorded_samples;
     }
-    [[nodiscard]] std::vector<float>& current_frequencies() {
-        const auto data = recorded_data();
-        auto magnitude = static_cast<size_t>(glm::log2(static_cast<float>(data.size())));
-        auto n = data.size();
-        for (size_t k = 0; k < n; k++) {
-            size_t rev_k = 0;
-            for (size_t b = 0; b < magnitude; b++) {
-                rev_k <<= 1;
-                if (k & (1 << b)) rev_k |= 1;
-            }
-
-            m_dft_real[rev_k] = data[k];
-            m_dft_imag[rev_k] = 0;
-        }
-
-        for (size_t s = 1; s < magnitude + 1; s++) {
-            const auto float_s = static_cast<double>(s);
-            const double m = glm::pow(2, float_s);
-            const auto w_m = glm::vec2(glm::cos(- 2 * M_PI / m), glm::sin(- 2 * M_PI / m));
-
-            for (size_t k = 0; k < n; k += static_cast<size_t>(m)) {
-                auto w = glm::vec2(1, 0);
-                const auto m_by_2 = static_cast<size_t>(m / 2);
-                for (size_t j = 0; j < m_by_2; j++) {
-                    const size_t t_index = k + j + m_by_2;
-                    const auto t = glm::vec2(w.r * m_dft_real[t_index] - w.g * m_dft_imag[t_index],
-                                             w.r * m_dft_imag[t_index] + w.g * m_dft_real[t_index]);
-                    const size_t u_index = k + j;
-                    const auto u = glm::vec2(m_dft_real[u_index], m_dft_imag[u_index]);
-
-                    m_dft_real[u_index] = u.r + t.r;
-                    m_dft_imag[u_index] = u.g + t.g;
-                    m_dft_real[t_index] = u.r - t.r;
-                    m_dft_imag[t_index] = u.g - t.g;
-
-                    w.r = w.r * w_m.r - w.g * w_m.g;
-                    w.g = w.r * w_m.g + w.g * w_m.r;
-                }
-            }
-        }
-
-        for (size_t i = 0; i < m_dft_out.size(); i++) {
-            if (i == 0) {
-                m_dft_out[i] = glm::length(glm::vec2(m_dft_real[i], m_dft_real[i]));
-                continue;
-            }
-            m_dft_out[i] = glm::length(glm::vec2(m_dft_real[n - i + 1], m_dft_real[n - i + 1])) + glm::length(
-                               glm::vec2(m_dft_real[i], m_dft_real[i]));
-        }
-
-        return m_dft_out;
+    [[nodiscard]] const AudioSource& source() const { return *m_source; }
+    // Samples the source has written since construction
+    [[nodiscard]] uint64_t captured_samples() const { return m_ring->write_cursor(); }
+    // Producer-side health, and what the analysis lost by falling behind; lock-free, any thread
+    [[nodiscard]] const CaptureStats& capture_stats() const { return m_source->stats(); }
+    [[nodiscard]] uint64_t analysis_lost_samples() const { return m_analysis->lost_samples(); }
+    [[nodiscard]] size_t sample_rate() const { return m_sample_rate; }
+    [[nodiscard]] size_t analysis_rate() const { return m_analysis_rate; }
+    [[nodiscard]] size_t fft_size() const { return m_fft_size; }
+    [[nodiscard]] size_t hop_size() const { return m_hop_size; }
+    [[nodiscard]] SpectrumEngine::Kind spectrum_engine() const { return m_analysis->stft().engine_kind(); }
+    [[nodiscard]] const Stft& stft() const { return m_analysis->stft(); }
+    // Centre frequency in Hz of a bin of `AnalysisFrame::magnitudes`
+    [[nodiscard]] float bin_frequency(const size_t bin) const {
+        return static_cast<float>(bin) * static_cast<float>(m_analysis_rate) / static_cast<float>(m_fft_size);
     }
+    // Bin of `AnalysisFrame::magnitudes` closest to `frequency` Hz
+    [[nodiscard]] size_t frequency_bin(const float frequency) const {
+        const auto bin = std::lround(frequency * static_cast<float>(m_fft_size) / static_cast<float>(m_analysis_rate));
+        return std::clamp<size_t>(std::max(bin, 0L), 0, m_fft_size / 2 - 1);
+    }
+    // Newest spectrum published by the analysis thread; never blocks. Call from one thread only (the renderer).
+    [[nodiscard]] const AnalysisFrame& latest_analysis() { return m_analysis->latest(); }
+    // Number of bands in `AnalysisFrame::band_energies`, can be changed while running
+    void set_band_count(const size_t band_count) { m_analysis->set_band_count(band_count); }
     void start_recognition() {
-        std::lock_guard<std::mutex> guard(m_recognition_mutex);
-        if (m_recognition_thread != nullptr) {
-            using namespace std;
-            cout << "Tried starting recognition when it has already started" << endl;
+        if (m_recognition_thread.joinable()) {
+            std::cout << "Tried starting recognition when it has already started" << std::endl;
+            return;
         }
-        m_continue_recognition = true;
-        m_recognition_thread = new std::thread(&AudioRecord::auxiliary_recognize, this);
+        m_recognition_thread = std::jthread([this](const std::stop_token &stop) { auxiliary_recognize(stop); });
     }
+    // Returns as soon as the thread is out of its current wait; an identification request already in flight is
+    // finished first
     void stop_recognition() {
-        {
-            std::lock_guard<std::mutex> guard(m_recognition_mutex);
-            m_continue_recognition = false;
-        }
-        if (m_recognition_thread == nullptr) {
-            return;
-        }
-        m_recognition_thread->join();
-        delete m_recognition_thread;
-        m_recognition_thread = nullptr;
+        if (!m_recognition_thread.joinable()) return;
+        m_recognition_thread.request_stop();
+        m_recognition_thread.join();
     }
+    [[nodiscard]] const RecognitionCache& recognition_cache() const { return m_recognition_cache; }
     [[nodiscard]] std::optional<std::string> cover_art_url() const { return get_cover_art_url(); }
     [[nodiscard]] std::optional<joe_colors_t> joe_colors() const { return get_joe_colors(); }
 private:
+    std::unique_ptr<AudioSource> m_source;
     size_t m_sample_rate;
+    size_t m_analysis_rate;
+    size_t m_fft_size;
+    size_t m_hop_size;
     size_t m_frame_size;
-    PaError m_err = paNoError;
-    PaStreamParameters m_input_parameters{};
-    PaStream* m_stream = nullptr;
-
-    AudioRecordCallback* m_arc = nullptr;
-    std::thread* m_recording_thread = nullptr;
-
-    bool m_continue_recognition;
-    std::thread* m_recognition_thread;
-    std::mutex m_recognition_mutex;
 
+    // The one capture stream; the spectrum and the recognizer read it at their own cursors
+    std::shared_ptr<CaptureRing> m_ring;
 
-    std::vector<float> m_dft_real;
-    std::vector<float> m_dft_imag;
-    std::vector<float> m_dft_out;
+    std::unique_ptr<AnalysisThread> m_analysis;
 
-    bool m_is_alive = true;
-
-    struct RecognitionData {
-        bool fill_buffer;
-        std::vector<float> buffer;
-        size_t buffer_limit;
-        size_t index;
-    };
-
-    static int callback(const void *input_buffer, void *output_buffer,
-                           const unsigned long frames_per_buffer,
-                           const PaStreamCallbackTimeInfo* time_info,
-                           PaStreamCallbackFlags status_flags,
-                           void *user_data)
-    {
-        const auto arc = static_cast<AudioRecordCallback*>(user_data);
-        return arc->callback(input_buffer, output_buffer, frames_per_buffer, time_info, status_flags);
-    }
-
-    static PaError auxiliary_start_recording(PaStream *stream, const PaStreamParameters *input_parameters,
-                                             const double sample_rate,
-                                             const size_t frame_size, AudioRecordCallback *arc) {
-        PaError err = Pa_OpenStream(
-            &stream,
-            input_parameters,
-            nullptr, /* &outputParameters, */
-            sample_rate,
-            frame_size,
-            paClipOff, /* we won't output out of range samples so don't bother clipping them */
-            &callback,
-            arc);
-        if(err != paNoError) {
-            return err;
-        }
-
-        err = Pa_StartStream(stream);
-        if( err != paNoError ) {
-            return err;
-        }
-
-        while(!arc->stopped_recording()) {
-            Pa_Sleep(100);
-        }
+    ThreadPolicy m_recognition_thread_policy;
+    RecognitionCache m_recognition_cache;
+    std::mutex m_recognition_mutex;
+    std::mutex m_recognition_wake_mutex;
+    std::condition_variable_any m_recognition_wake;
+    // Declared after what it waits on, so it is joined before they go away
+    std::jthread m_recognition_thread;
+
+    bool m_is_alive;
+
+    static constexpr size_t CAPTURE_RING_SECONDS = 10;
+    // Fingerprints of growing windows are queried until one identifies the song: most match on the shortest one,
+    // the longer ones are for quiet or noisy passages
+    static constexpr std::array<size_t, 3> RECOGNITION_WINDOW_SECONDS = {3, 6, 9};
+    // Without a detected change, the same song is checked again after the fallback interval, which doubles after
+    // every match up to the maximum and goes back to the minimum on a change or a failed match
+    static constexpr size_t RECOGNITION_MIN_INTERVAL_SECONDS = 10;
+    static constexpr size_t RECOGNITION_MAX_INTERVAL_SECONDS = 160;
+
+    void auxiliary_recognize(const std::stop_token &stop) {
+        using namespace std;
+        ThreadTuning::apply("recognition", m_recognition_thread_policy);
+        uint64_t handled_changes = 0;
+        std::chrono::seconds interval(RECOGNITION_MIN_INTERVAL_SECONDS);
+
+        while(!stop.stop_requested()) {
+            // The first music heard counts as a change, so this also covers starting up
+            cout << "Waiting up to " << interval.count() << " s for the music to change" << endl;
+            const bool changed = wait_for_change(stop, interval, handled_changes);
+            if (stop.stop_requested()) break;
+            if (changed) {
+                handled_changes = m_analysis->music_changes();
+                interval = std::chrono::seconds(RECOGNITION_MIN_INTERVAL_SECONDS);
+            } else if (m_analysis->silent()) {
+                cout << "Silence, nothing to recognise" << endl;
+                continue;
+            }
 
-        err = Pa_StopStream(stream);
-        if(err != paNoError) {
-            return err;
+            const auto started = std::chrono::steady_clock::now();
+            const auto matched = recognize_progressively(stop);
+            if (!matched.has_value()) continue;
+            const std::chrono::duration<double> took = std::chrono::steady_clock::now() - started;
+            cout << "Recognition took " << took.count() << " s" << endl;
+            interval = *matched ? std::min(interval * 2, std::chrono::seconds(RECOGNITION_MAX_INTERVAL_SECONDS))
+                                : std::chrono::seconds(RECOGNITION_MIN_INTERVAL_SECONDS);
+            cout << get_cover_art_url().value_or("No cover art") << endl;
         }
-
-        // delete *arc;
-        // *arc = nullptr;
-        return err;
     }
 
-    static int recognize_callback(const void *input_buffer, void *output_buffer,
-                           const unsigned long frames_per_buffer,
-                           const PaStreamCallbackTimeInfo* time_info,
-                           PaStreamCallbackFlags status_flags,
-                           void *user_data)
-    {
-
-        const auto recognition_data = static_cast<RecognitionData*>(user_data);
-        if (!recognition_data->fill_buffer) return paContinue;
-        const auto *read_ptr = static_cast<const float *>(input_buffer);
-
-        const auto free_space = recognition_data->buffer_limit - recognition_data->index;
-        const auto end = std::min(free_space, frames_per_buffer);
-        for(size_t i=0; i<end; i++) {
-            recognition_data->buffer[recognition_data->index++] = read_ptr[i];
-        }
-
-        if (recognition_data->index >= recognition_data->buffer_limit) {
-            recognition_data->fill_buffer = false;
-        }
-
-        return paContinue;
-    }
-    void auxiliary_recognize() {
+    // One recognition of the audio from now on: as soon as each window of RECOGNITION_WINDOW_SECONDS has been
+    // captured it is fingerprinted and queried, on a thread of its own so a longer window never waits for a shorter
+    // one's answer. The first answer that identifies the song is taken and the queries still running are cancelled.
+    // A fingerprint the cache already knows is not queried at all. Whether it matched, or nothing if there was no audio to try or a stop was requested.
+    std::optional<bool> recognize_progressively(const std::stop_token &stop) {
         using namespace std;
-        PaStream* stream;
-        RecognitionData recognition_data {
-            .fill_buffer = false,
-            .buffer_limit = 44100*4,
-            .index = 0
-        };
-        recognition_data.buffer = std::vector<float>(recognition_data.buffer_limit);
-        cout << "Buffer max: " << ranges::max(recognition_data.buffer) << endl;
-        cout << "Buffer min: " << ranges::min(recognition_data.buffer) << endl;
-        PaError err = Pa_OpenStream(
-            &stream,
-            &m_input_parameters,
-            nullptr, /* &outputParameters, */
-            44100,
-            512,
-            paClipOff, /* we won't output out of range samples so don't bother clipping them */
-            &recognize_callback,
-            &recognition_data
-        );
-        if(err != paNoError) {
-            // return err;
-        }
-
-        err = Pa_StartStream(stream);
-        if( err != paNoError ) {
-            // return err;
-        }
-
-
-        while(continue_recognition()) {
-            cout << "new loop" << endl;
-
-            recognition_data.index = 0;
-            recognition_data.fill_buffer = true;
-            cout << "recording" << endl;
-            Pa_Sleep(5000);
-            cout << "samples: " << recognition_data.index << " and " << recognition_data.buffer.size() << endl;
-            cout << "Buffer max: " << ranges::max(recognition_data.buffer) << endl;
-            cout << "Buffer min: " << ranges::min(recognition_data.buffer) << endl;
-            recognition_data.fill_buffer = false;
+        const uint64_t start = m_ring->write_cursor();
+        std::atomic<bool> cancel = false;
+        std::vector<std::future<void>> queries;
+        // In the order they arrived, under m_recognition_wake_mutex
+        std::vector<std::optional<RecognizedTrack>> answers;
+        size_t handled_answers = 0;
+        std::optional<RecognizedTrack> match;
+        size_t next_window = 0;
+
+        while (!stop.stop_requested()) {
             {
-                cout << "Getting recognition lock in loop" << endl;
-                std::lock_guard<std::mutex> guard(m_recognition_mutex);
-                auto recorded_data = recognition_data.buffer;
-                cout << "Getting finger print" << endl;
-                auto fp = vibra_get_fingerprint_from_float_pcm(reinterpret_cast<const char *>(recorded_data.data()),
-                                                               recognition_data.index * sizeof(float), 44100,
-                                                               sizeof(float) * 8, 1);
-                cout << "Fingerprint: " << fp->uri << endl;
-                recognize(fp);
-                cout << get_cover_art_url().value_or("No cover art") << endl;
-                // if (get_cover_art_url().has_value()) {
-                // Communication::cover_art("https://is1-ssl.mzstatic.com/image/thumb/Music117/v4/28/c6/34/28c63410-4520-f854-4c14-b584ec906965/cover.jpg/400x400cc.jpg");
-                // }
+                std::lock_guard<std::mutex> guard(m_recognition_wake_mutex);
+                for (; handled_answers < answers.size() && !match.has_value(); handled_answers++) {
+                    match = std::move(answers[handled_answers]);
+                }
+            }
+            if (match.has_value()) break;
+            const auto answered = [&answers, &handled_answers] { return answers.size() > handled_answers; };
+            if (next_window == RECOGNITION_WINDOW_SECONDS.size()) {
+                if (handled_answers == queries.size()) break;
+                wait_for_answer(stop, std::chrono::seconds(RECOGNITION_WINDOW_SECONDS.back()), answered);
+                continue;
             }
 
-            cout << "Sleeping loop" << endl;
-            Pa_Sleep(10000);
+            // Only audio from after the round started
+            const size_t window_size = m_sample_rate * RECOGNITION_WINDOW_SECONDS[next_window];
+            const uint64_t captured = m_ring->write_cursor() - start;
+            if (captured < window_size) {
+                if (!m_source->is_active()) break;
+                const std::chrono::duration<double> missing(static_cast<double>(window_size - captured) /
+                                                            static_cast<double>(m_sample_rate));
+                wait_for_answer(stop, std::chrono::duration_cast<std::chrono::steady_clock::duration>(missing),
+                                answered);
+                continue;
+            }
+            next_window++;
+
+            // Viewed in place: the samples are not copied out of the ring
+            const auto window = m_ring->latest_window(window_size);
+            auto fp = vibra_get_fingerprint_from_float_pcm(reinterpret_cast<const char *>(window.samples.data()),
+                                                           static_cast<int>(window.samples.size_bytes()),
+                                                           static_cast<int>(m_sample_rate),
+                                                           sizeof(float) * 8, 1);
+            if (!m_ring->valid(window)) {
+                // The source lapped the window while it was being fingerprinted; the next, longer one is fresher
+                cout << "Recognition window overwritten during fingerprinting" << endl;
+                continue;
+            }
+            if (auto cached = m_recognition_cache.find_fingerprint(fp->uri)) {
+                cout << "Fingerprint of " << RECOGNITION_WINDOW_SECONDS[next_window - 1] << " s already recognised"
+                     << endl;
+                match = std::move(cached);
+                break;
+            }
+            cout << "Querying " << RECOGNITION_WINDOW_SECONDS[next_window - 1] << " s of audio up to "
+                 << std::chrono::duration<double>(std::chrono::steady_clock::now() - window.captured).count()
+                 << " s old" << endl;
+            // vibra hands out one static Fingerprint that the next, longer window overwrites while this query may
+            // still be sending it, so each query gets its own copy
+            queries.push_back(std::async(std::launch::async, [this, fingerprint = *fp, &cancel, &answers] {
+                auto answer = identify(fingerprint.uri, Shazam::Recognize(&fingerprint, &cancel));
+                {
+                    std::lock_guard<std::mutex> guard(m_recognition_wake_mutex);
+                    answers.push_back(std::move(answer));
+                }
+                m_recognition_wake.notify_all();
+            }));
         }
 
+        // Abandoned queries return on their next progress callback, and have to before what they point at goes away
+        cancel = true;
+        for (auto &query : queries) query.wait();
+        if (stop.stop_requested() || (queries.empty() && !match.has_value())) return std::nullopt;
+        std::lock_guard<std::mutex> guard(m_recognition_mutex);
+        return recognize(match);
+    }
 
-        err = Pa_StopStream(stream);
-        if(err != paNoError) {
-            // return err;
-        }
-        // recognize_callback->call(fp);
-        // std::ofstream outFile("/Users/sebastian/CLionProjects/soundscape/my_file.txt");
-        // // the important part
-        // for (const auto &e : data) outFile << e << ", ";
+    // The track a Shazam response identifies, if any, remembered under the queried fingerprint's `signature`. A
+    // track id seen before, in this run or an earlier one, is taken from the cache instead of the response.
+    std::optional<RecognizedTrack> identify(const std::string &signature, const std::string &response) {
+        const auto track = parse_track(response);
+        if (!track.has_value()) return std::nullopt;
+        const auto key = track->find("key");
+        auto recognized = key != track->end() && key->is_string()
+                              ? m_recognition_cache.find_track(key->template get<std::string>())
+                              : std::nullopt;
+        if (!recognized.has_value()) recognized = describe_track(*track);
+        m_recognition_cache.insert(signature, *recognized);
+        return recognized;
     }
 
-    bool continue_recognition() {
-        std::lock_guard<std::mutex> guard(m_recognition_mutex);
-        return m_continue_recognition;
+    // Sleeps for `duration`, or until `answered` holds after a wake-up, or until a stop is requested
+    template<typename Answered>
+    void wait_for_answer(const std::stop_token &stop, const std::chrono::steady_clock::duration duration,
+                         Answered answered) {
+        std::unique_lock lock(m_recognition_wake_mutex);
+        m_recognition_wake.wait_for(lock, stop, duration, answered);
+    }
+    // Sleeps until the analysis has seen more than `seen` music changes, for at most `duration`. True on a change,
+    // false on the timeout or a stop request.
+    bool wait_for_change(const std::stop_token &stop, const std::chrono::steady_clock::duration duration,
+                         const uint64_t seen) {
+        std::unique_lock lock(m_recognition_wake_mutex);
+        return m_recognition_wake.wait_for(lock, stop, duration,
+                                           [this, seen] { return m_analysis->music_changes() != seen; });
     }
 };
 
@@ -0,0 +1,57 @@
+//
+// Created by Sebastian Sandstig on 2026-10-17.
+//
+
+#ifndef AUDIOSOURCE_H
+#define AUDIOSOURCE_H
+
+#include <memory>
+#include <string>
+
+#include <CaptureRing.h>
+#include <CaptureStats.h>
+#include <PcmFormat.h>
+#include <ThreadTuning.h>
+
+// What to capture from, as given on the command line
+struct AudioSourceSettings {
+    // portaudio | synthetic[:SIGNALS] (see SyntheticSource::parse) | file:PATH | pipe:PATH | - (raw PCM on stdin)
+    std::string source = "portaudio";
+    size_t sample_rate = 0;         // PortAudio: 0 for the device's rate. Synthetic and raw PCM: 0 for 48000.
+    double speed = 1.0;             // Files and synthetic audio: multiple of real time, 0 as fast as possible
+    bool loop = false;              // Files: start over at the end
+    PcmFormat pcm_format;           // Raw PCM files and pipes
+};
+
+// Something that produces mono float samples at a fixed rate and writes them into a capture ring, in blocks,
+// from a thread of its own (the PortAudio callback, a generator, ...). Everything downstream (the analysis thread,
+// the recognizer) only ever sees the ring, so any source can stand in for the sound card.
+class AudioSource {
+public:
+    virtual ~AudioSource() = default;
+
+    [[nodiscard]] virtual const char* name() const = 0;
+    // Samples per second written to the ring; fixed for the lifetime of the source
+    [[nodiscard]] virtual size_t sample_rate() const = 0;
+    // False if the source can never deliver (no input device, ...)
+    [[nodiscard]] virtual bool is_alive() const = 0;
+    // True while samples are being written
+    [[nodiscard]] virtual bool is_active() const = 0;
+    // Counters and timings of the writing side, readable from any thread
+    [[nodiscard]] const CaptureStats& stats() const { return m_stats; }
+    // Scheduling for the thread that writes into the ring, applied by that thread from the next start()
+    void set_thread_policy(ThreadPolicy policy) { m_thread_policy = std::move(policy); }
+
+    // Starts writing `frame_size` samples at a time into `ring`. Returns false if the source could not start.
+    virtual bool start(const std::shared_ptr<CaptureRing> &ring, size_t frame_size) = 0;
+    // Stops writing and returns once nothing will touch the ring any more
+    virtual void stop() = 0;
+
+    // Throws std::runtime_error for an unknown source or one that cannot be opened
+    static std::unique_ptr<AudioSource> create(const AudioSourceSettings &settings);
+protected:
+    CaptureStats m_stats;
+    ThreadPolicy m_thread_policy;
+};
+
+#endif //AUDIOSOURCE_H
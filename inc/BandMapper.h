@@ -0,0 +1,73 @@
+//
+// Created by Sebastian Sandstig on 2026-10-17.
+//
+
+#ifndef BANDMAPPER_H
+#define BANDMAPPER_H
+
+#include <optional>
+#include <span>
+#include <string>
+#include <vector>
+
+// Folds an FFT magnitude spectrum into a handful of perceptually spaced bands.
+// Each band is a triangular filter over the bins near its centre frequency. The filters are built once per
+// (fft size, sample rate, band count, range, scale) and stored sparsely: a band only keeps the contiguous run of
+// bins it actually covers, with the weights normalised to sum to one, so `apply` costs a few multiply-adds per band
+// and a band reads as the weighted mean magnitude of its bins.
+class BandMapper {
+public:
+    enum Scale {
+        LOG = 0,        // Centres evenly spaced in log frequency, triangles symmetric in log frequency
+        MEL,            // Centres evenly spaced on the mel scale, triangles between neighbouring centres in Hz
+        CONSTANT_Q      // Log spaced centres, every triangle as wide as a fixed fraction of its centre frequency
+    };
+
+    BandMapper(size_t fft_size, size_t sample_rate, size_t band_count, float low_frequency, float high_frequency,
+               Scale scale = MEL);
+
+    [[nodiscard]] size_t fft_size() const { return m_fft_size; }
+    [[nodiscard]] size_t sample_rate() const { return m_sample_rate; }
+    [[nodiscard]] size_t band_count() const { return m_bands.size(); }
+    [[nodiscard]] Scale scale() const { return m_scale; }
+    [[nodiscard]] float low_frequency() const { return m_low_frequency; }
+    [[nodiscard]] float high_frequency() const { return m_high_frequency; }
+    [[nodiscard]] float center_frequency(size_t band) const { return m_bands[band].center; }
+    // Where the band's triangle starts and ends, in Hz
+    [[nodiscard]] float lower_frequency(size_t band) const { return m_bands[band].lower; }
+    [[nodiscard]] float upper_frequency(size_t band) const { return m_bands[band].upper; }
+    // Non-zero weights stored across all bands
+    [[nodiscard]] size_t weight_count() const { return m_weights.size(); }
+
+    // Rebuilds the filters for a new band count. Allocates, keep it off the audio callback.
+    void set_band_count(size_t band_count);
+
+    // `magnitudes` holds at least fft_size() / 2 bins, `bands` at least band_count() values
+    void apply(std::span<const float> magnitudes, std::span<float> bands) const;
+    // Only bands [first_band, last_band) are written
+    void apply(std::span<const float> magnitudes, std::span<float> bands, size_t first_band, size_t last_band) const;
+
+    static const char* scale_name(Scale scale);
+    static std::optional<Scale> parse_scale(const std::string &name);
+private:
+    struct Band {
+        size_t first_bin;
+        size_t weight_offset;
+        size_t weight_count;
+        float lower;
+        float center;
+        float upper;
+    };
+
+    size_t m_fft_size;
+    size_t m_sample_rate;
+    float m_low_frequency;
+    float m_high_frequency;
+    Scale m_scale;
+    std::vector<Band> m_bands;
+    std::vector<float> m_weights;
+
+    void build(size_t band_count);
+};
+
+#endif //BANDMAPPER_H
@@ -0,0 +1,77 @@
+//
+// Created by Sebastian Sandstig on 2026-10-17.
+//
+
+#ifndef BEATTRACKER_H
+#define BEATTRACKER_H
+
+#include <cstdint>
+#include <span>
+#include <vector>
+
+// What the renderer sees of the beat tracker, published with every analysis frame.
+// Frames can be dropped on the way to the renderer, so onsets and beats are counters: compare with the last value
+// seen to learn whether one happened in between.
+struct BeatState {
+    float onset_strength = 0.0f;    // Band-averaged rectified spectral flux of the newest hop
+    float threshold = 0.0f;         // Adaptive level an onset has to peak above
+    float tempo = 0.0f;             // Beats per minute, 0 until enough onsets have been seen
+    float beat_phase = 0.0f;        // [0, 1), 0 on the beat
+    uint64_t onset_count = 0;
+    uint64_t beat_count = 0;
+};
+
+// Onset detection and beat tracking from successive band spectra taken at a fixed hop rate.
+// Per hop: log-compressed band energies are differenced with the previous hop and half-wave rectified (spectral
+// flux), onsets are peaks of the flux above a running mean + deviation threshold, the tempo is the strongest lag of
+// an exponentially decaying autocorrelation of the onset envelope within 60..200 BPM, and a phase oscillator at
+// that tempo is pulled towards detected onsets. Everything is preallocated: `process` is O(bands + lags), no
+// allocation, meant to run right after the FFT on the analysis thread.
+class BeatTracker {
+public:
+    BeatTracker(size_t band_count, float frame_rate);
+
+    [[nodiscard]] size_t band_count() const { return m_previous.size(); }
+    [[nodiscard]] float frame_rate() const { return m_frame_rate; }
+    [[nodiscard]] const BeatState& state() const { return m_state; }
+
+    // Feeds one hop worth of band energies (linear magnitudes), `band_count()` of them
+    void process(std::span<const float> band_energies);
+    // Resizes the per-band state; allocates. Flux restarts from the next hop.
+    void set_band_count(size_t band_count);
+private:
+    float m_frame_rate;
+    size_t m_min_lag;                   // Hops per beat at the fastest tempo considered
+    size_t m_max_lag;                   // ... and at the slowest
+    float m_correlation_decay;
+    float m_envelope_decay;
+
+    std::vector<float> m_previous;      // Compressed band energies of the previous hop
+    bool m_primed = false;
+
+    // Onset strength of the last hops, for the adaptive threshold and peak picking
+    std::vector<float> m_flux_history;
+    size_t m_flux_position = 0;
+    float m_flux_sum = 0.0f;
+    float m_flux_square_sum = 0.0f;
+    float m_previous_flux = 0.0f;
+    float m_previous_previous_flux = 0.0f;
+    size_t m_hops_since_onset = 0;
+
+    // Onset envelope (flux above its slow mean) and its autocorrelation per lag
+    std::vector<float> m_envelope;
+    size_t m_envelope_position = 0;
+    float m_envelope_mean = 0.0f;
+    std::vector<float> m_correlation;
+    std::vector<float> m_tempo_prior;   // Per lag, favours tempi near 120 BPM over their halves and doubles
+    uint64_t m_hop_count = 0;
+
+    float m_period = 0.0f;              // Hops per beat, 0 while unknown
+    BeatState m_state;
+
+    void pick_onset(float flux, float threshold);
+    void estimate_tempo(float envelope);
+    void advance_phase(bool onset);
+};
+
+#endif //BEATTRACKER_H
@@ -0,0 +1,56 @@
+//
+// Created by Sebastian Sandstig on 2026-10-17.
+//
+
+#ifndef BLOCKSOURCE_H
+#define BLOCKSOURCE_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+
+#include <AudioSource.h>
+
+// Base of the sources that make their samples themselves (generated, decoded from a file, read from a pipe) rather
+// than being called back by a driver. Subclasses only produce blocks; this runs the thread that writes them into
+// the ring, paced at `speed` times real time like a sound card would deliver them, or as fast as they come with 0.
+// Nothing holds the source back for slow consumers: one that falls a ring behind loses audio, as with a real card.
+class BlockSource : public AudioSource {
+public:
+    ~BlockSource() override;
+
+    BlockSource(const BlockSource&) = delete;
+    BlockSource& operator=(const BlockSource&) = delete;
+
+    [[nodiscard]] bool is_active() const override { return m_active.load(std::memory_order_acquire); }
+    [[nodiscard]] double speed() const { return m_speed; }
+    // Samples written to the ring so far
+    [[nodiscard]] uint64_t position() const { return m_position.load(std::memory_order_acquire); }
+
+    bool start(const std::shared_ptr<CaptureRing> &ring, size_t frame_size) override;
+    void stop() override;
+protected:
+    explicit BlockSource(double speed);
+
+    // Fills up to `count` samples and returns how many it did; 0 ends the stream. Runs on the source's thread. May
+    // block, as long as `wake` makes it return promptly. Subclasses must `stop()` in their own destructor, as the
+    // thread calls into them.
+    virtual size_t produce(float *samples, size_t count) = 0;
+    // Called by `stop()` to unblock a `produce` that is waiting on something other than this class
+    virtual void wake() {}
+    [[nodiscard]] bool stop_requested();
+private:
+    double m_speed;
+    std::atomic<uint64_t> m_position = 0;
+    std::atomic<bool> m_active = false;
+    std::mutex m_mutex;
+    std::condition_variable m_wake;
+    bool m_stop = false;
+    std::thread m_thread;
+
+    void run(std::shared_ptr<CaptureRing> ring, size_t frame_size);
+};
+
+#endif //BLOCKSOURCE_H
@@ -0,0 +1,284 @@
+//
+// Created by Sebastian Sandstig on 2026-10-17.
+//
+
+#ifndef CAPTURERING_H
+#define CAPTURERING_H
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+// Single-producer ring of mono float samples shared by any number of consumers.
+// The producer (audio callback) never blocks: when it laps a consumer the oldest samples are overwritten and the
+// consumer notices through the cursors. Cursors count samples since construction and never wrap.
+class CaptureRing {
+public:
+    // A consumer's private read position. Each consumer (spectrum, recognizer, ...) owns one and advances it at its
+    // own pace; the producer never looks at it.
+    class Reader {
+    public:
+        explicit Reader(const CaptureRing &ring) : m_ring(&ring), m_cursor(ring.write_cursor()) {}
+
+        [[nodiscard]] uint64_t cursor() const { return m_cursor; }
+        // Samples the producer overwrote before this reader got to them, since construction
+        [[nodiscard]] uint64_t lost() const { return m_lost; }
+        // Samples written but not yet consumed, clamped to what is still in the ring
+        [[nodiscard]] size_t available() const {
+            return static_cast<size_t>(std::min<uint64_t>(m_ring->write_cursor() - m_cursor, m_ring->capacity()));
+        }
+        // Drops everything pending so the next read starts at the newest sample
+        void skip_to_latest() { m_cursor = m_ring->write_cursor(); }
+        // When the newest sample consumed was captured. A read that stops inside a write leaves the stamp of an
+        // earlier write here, so it may be older than the samples, never newer. The epoch until a read reaches
+        // the end of a write.
+        [[nodiscard]] std::chrono::steady_clock::time_point captured() const { return m_captured; }
+
+        // Consumes up to `count` samples in order. If the producer lapped us the lost samples are skipped.
+        size_t read(float *dst, const size_t count) {
+            const Stamp newest = m_ring->stamp();
+            const uint64_t write = newest.cursor;
+            if (write - m_cursor > m_ring->capacity()) skip_to(write - m_ring->capacity());
+
+            const size_t n = static_cast<size_t>(std::min<uint64_t>(write - m_cursor, count));
+            m_ring->copy_out(m_cursor, dst, n);
+
+            // Anything overwritten during the copy, or by a write still in progress, is stale; move past it rather
+            // than handing it out
+            if (!m_ring->intact(m_cursor)) {
+                skip_to(m_ring->overwrite_cursor() - m_ring->capacity());
+                return 0;
+            }
+
+            m_cursor += n;
+            if (m_cursor == write) m_captured = newest.captured;
+            return n;
+        }
+
+    private:
+        const CaptureRing *m_ring;
+        uint64_t m_cursor;
+        uint64_t m_lost = 0;
+        std::chrono::steady_clock::time_point m_captured;
+
+        void skip_to(const uint64_t cursor) {
+            m_lost += cursor - m_cursor;
+            m_cursor = cursor;
+        }
+    };
+
+    // Any window of up to `contiguous` samples (at most the capacity) can also be viewed as a single span, see
+    // `latest_window`. This costs writing the first `contiguous` samples of the ring twice.
+    explicit CaptureRing(const size_t min_capacity, const size_t contiguous = 0)
+        : m_samples(round_up_pow2(min_capacity) + std::min(contiguous, round_up_pow2(min_capacity))),
+        m_mask(round_up_pow2(min_capacity) - 1), m_contiguous(m_samples.size() - capacity()) {}
+    ~CaptureRing() = default;
+
+    CaptureRing(const CaptureRing&) = delete;
+    CaptureRing& operator=(const CaptureRing&) = delete;
+
+    [[nodiscard]] size_t capacity() const { return m_mask + 1; }
+    [[nodiscard]] size_t contiguous_capacity() const { return m_contiguous; }
+    // The sample storage, to lock it in memory
+    [[nodiscard]] std::span<const std::byte> memory() const { return std::as_bytes(std::span(m_samples)); }
+    [[nodiscard]] uint64_t write_cursor() const { return m_write_cursor.load(std::memory_order_acquire); }
+    // The most samples a single write has put in so far, which is how far ahead of `write_cursor()` a write in
+    // progress can reach
+    [[nodiscard]] size_t largest_block() const { return m_largest_block.load(std::memory_order_relaxed); }
+    // The newest write's end and when its last sample was captured, read as a pair; the capture time is the epoch
+    // if the producer never stamps. Every sample before `cursor` is visible once this returns.
+    struct Stamp {
+        uint64_t cursor;
+        std::chrono::steady_clock::time_point captured;
+    };
+    [[nodiscard]] Stamp stamp() const {
+        // Seqlock: an odd sequence or one that moved means a write was stamping meanwhile, which takes nanoseconds
+        for (;;) {
+            const uint32_t sequence = m_stamp_sequence.load(std::memory_order_acquire);
+            const uint64_t cursor = m_stamp_cursor.load(std::memory_order_relaxed);
+            const auto time = m_write_time.load(std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if ((sequence & 1) == 0 && m_stamp_sequence.load(std::memory_order_relaxed) == sequence) {
+                return Stamp {cursor, std::chrono::steady_clock::time_point(std::chrono::steady_clock::duration(time))};
+            }
+        }
+    }
+    // When the newest sample was captured. Read after `write_cursor()` it may already belong to a newer write; use
+    // `stamp()` or a Reader's `captured()` to know which samples it belongs to.
+    [[nodiscard]] std::chrono::steady_clock::time_point write_time() const { return stamp().captured; }
+
+    // Producer side. `samples == nullptr` writes silence. `captured` is when the last of the samples was captured
+    // (the ADC time for a sound card). Wait-free, no allocation.
+    void write(const float *samples, size_t count, const std::chrono::steady_clock::time_point captured = {}) {
+        uint64_t write = m_write_cursor.load(std::memory_order_relaxed);
+        if (count > capacity()) {
+            // Only the newest `capacity()` samples can survive anyway
+            const size_t skipped = count - capacity();
+            if (samples != nullptr) samples += skipped;
+            write += skipped;
+            count = capacity();
+        }
+
+        if (count > m_largest_block.load(std::memory_order_relaxed)) {
+            m_largest_block.store(count, std::memory_order_relaxed);
+        }
+        // Announce the samples about to be overwritten before touching them, see `intact`
+        m_overwrite_cursor.store(write + count, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+
+        const size_t pos = write & m_mask;
+        const size_t first = std::min(count, capacity() - pos);
+        const size_t second = count - first;
+        if (samples != nullptr) {
+            std::memcpy(m_samples.data() + pos, samples, first * sizeof(float));
+            std::memcpy(m_samples.data(), samples + first, second * sizeof(float));
+        } else {
+            std::memset(m_samples.data() + pos, 0, first * sizeof(float));
+            std::memset(m_samples.data(), 0, second * sizeof(float));
+        }
+        // Mirror what landed at the start of the ring past its end, where windows that wrap continue reading
+        if (pos < m_contiguous) mirror(pos, std::min(pos + first, m_contiguous));
+        if (second > 0) mirror(0, std::min(second, m_contiguous));
+
+        const uint32_t sequence = m_stamp_sequence.load(std::memory_order_relaxed);
+        m_stamp_sequence.store(sequence + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        m_stamp_cursor.store(write + count, std::memory_order_relaxed);
+        m_write_time.store(captured.time_since_epoch().count(), std::memory_order_relaxed);
+        m_stamp_sequence.store(sequence + 2, std::memory_order_release);
+        m_write_cursor.store(write + count, std::memory_order_release);
+        // Only enters the kernel when a consumer is actually parked in wait()
+        m_epoch.fetch_add(1, std::memory_order_release);
+        m_epoch.notify_all();
+    }
+
+    // Blocking consumers: read `epoch()`, consume what is there, then `wait(epoch)` until something newer arrives.
+    // Reading the epoch before consuming means a write racing with the consumer is never slept through.
+    [[nodiscard]] uint32_t epoch() const { return m_epoch.load(std::memory_order_acquire); }
+    void wait(const uint32_t epoch) const { m_epoch.wait(epoch, std::memory_order_acquire); }
+    // Wakes every waiter without writing anything, e.g. so a consumer thread can notice it is being stopped
+    void interrupt() {
+        m_epoch.fetch_add(1, std::memory_order_release);
+        m_epoch.notify_all();
+    }
+
+    // Zero-copy view of the newest samples: `older` followed by `newer` is the window in time order (two pieces
+    // because the window may straddle the end of the ring). `sequence` is the write cursor the view was taken at;
+    // pass the snapshot to `valid` after using the spans to learn whether the producer overwrote any of it.
+    struct Snapshot {
+        std::span<const float> older;
+        std::span<const float> newer;
+        uint64_t sequence;
+    };
+
+    // `count` must not exceed `capacity()`. Before the ring has filled, the front of the window reads as silence.
+    [[nodiscard]] Snapshot snapshot(const size_t count) const {
+        return snapshot(write_cursor(), count);
+    }
+    // Same for the `count` samples ending just before cursor `end` (which must not be ahead of the write cursor)
+    [[nodiscard]] Snapshot snapshot(const uint64_t end, const size_t count) const {
+        // Unsigned wrap is fine here: positions are taken modulo the power-of-two capacity
+        const size_t pos = (end - count) & m_mask;
+        const size_t first = std::min(count, capacity() - pos);
+        return Snapshot {
+            .older = std::span<const float>(m_samples.data() + pos, first),
+            .newer = std::span<const float>(m_samples.data(), count - first),
+            .sequence = end,
+        };
+    }
+    [[nodiscard]] bool valid(const Snapshot &snapshot) const {
+        return intact(snapshot.sequence - snapshot.older.size() - snapshot.newer.size());
+    }
+
+    // Zero-copy view of the newest samples as one span, for consumers that need a single buffer (the fingerprinter).
+    // The producer never waits for it: the window stays intact while fewer than `capacity() - samples.size()` samples
+    // have been written since, counting the block being written, so only for `capacity() - samples.size()` minus one
+    // `largest_block()` of completed writes; after that `valid` turns false. Size the ring with enough headroom for
+    // the consumer to be done with it.
+    struct Window {
+        std::span<const float> samples;
+        uint64_t sequence;                                  // Write cursor just past the last sample
+        std::chrono::steady_clock::time_point captured;     // When the last sample was captured
+    };
+
+    // `count` must not exceed `contiguous_capacity()`
+    [[nodiscard]] Window latest_window(const size_t count) const {
+        const Stamp newest = stamp();
+        return Window {
+            .samples = std::span<const float>(m_samples.data() + ((newest.cursor - count) & m_mask), count),
+            .sequence = newest.cursor,
+            .captured = newest.captured,
+        };
+    }
+    [[nodiscard]] bool valid(const Window &window) const {
+        return intact(window.sequence - window.samples.size());
+    }
+
+    // Copies the newest `count` samples, oldest first, without touching any reader. Returns false if the producer
+    // overwrote the region while it was being copied. `count` has to stay below `capacity()` minus the largest block,
+    // or a write that merely begins during the copy tears it and a retry loop could spin for as long as the producer
+    // keeps writing.
+    bool read_latest(float *dst, const size_t count) const {
+        if (count + largest_block() >= capacity()) {
+            throw std::runtime_error("CaptureRing::read_latest: " + std::to_string(count) +
+                                     " samples leave no room for a " + std::to_string(largest_block()) +
+                                     "-sample write in a ring of " + std::to_string(capacity()));
+        }
+        const auto window = snapshot(count);
+        std::memcpy(dst, window.older.data(), window.older.size() * sizeof(float));
+        std::memcpy(dst + window.older.size(), window.newer.data(), window.newer.size() * sizeof(float));
+
+        return valid(window);
+    }
+
+private:
+    std::vector<float> m_samples;                   // The ring, followed by the mirror of its first `m_contiguous`
+    size_t m_mask;
+    size_t m_contiguous;
+
+    alignas(64) std::atomic<uint64_t> m_write_cursor = 0;
+    // Where `m_write_cursor` will be once the write in progress lands; stored before its samples are touched
+    std::atomic<uint64_t> m_overwrite_cursor = 0;
+    std::atomic<size_t> m_largest_block = 0;        // Only stored by the producer
+    // The newest write's `Stamp`, guarded by `m_stamp_sequence` (odd while the producer updates it)
+    std::atomic<uint32_t> m_stamp_sequence = 0;
+    std::atomic<uint64_t> m_stamp_cursor = 0;
+    std::atomic<std::chrono::steady_clock::rep> m_write_time = 0;
+    std::atomic<uint32_t> m_epoch = 0;
+
+    [[nodiscard]] uint64_t overwrite_cursor() const { return m_overwrite_cursor.load(std::memory_order_relaxed); }
+
+    // Whether the samples from cursor `start` on that a consumer has just read were left alone by every write that
+    // finished or began meanwhile. Seqlock-style: the fence keeps the sample reads before the cursor load, so if one
+    // of them saw a sample from a newer write, the load sees at least that write's announcement.
+    [[nodiscard]] bool intact(const uint64_t start) const {
+        std::atomic_thread_fence(std::memory_order_acquire);
+        return overwrite_cursor() - start <= capacity();
+    }
+
+    void copy_out(const uint64_t from, float *dst, const size_t count) const {
+        const size_t pos = from & m_mask;
+        const size_t first = std::min(count, capacity() - pos);
+        std::memcpy(dst, m_samples.data() + pos, first * sizeof(float));
+        std::memcpy(dst + first, m_samples.data(), (count - first) * sizeof(float));
+    }
+
+    void mirror(const size_t from, const size_t to) {
+        if (to <= from) return;
+        std::memcpy(m_samples.data() + capacity() + from, m_samples.data() + from, (to - from) * sizeof(float));
+    }
+
+    static size_t round_up_pow2(const size_t n) {
+        size_t p = 1;
+        while (p < n) p <<= 1;
+        return p;
+    }
+};
+
+#endif //CAPTURERING_H
@@ -0,0 +1,34 @@
+//
+// Created by Sebastian Sandstig on 2026-10-17.
+//
+
+#ifndef CAPTURESTATS_H
+#define CAPTURESTATS_H
+
+#include <atomic>
+#include <cstdint>
+#include <ostream>
+
+#include <LatencyHistogram.h>
+
+// Health of the producer side of the capture ring, written by the source's thread (the audio callback) with relaxed
+// atomics and readable from any thread without locking. Together with the consumers' lost-sample counts it tells a
+// starving callback (large gaps, overflows) from a stalled consumer (samples lost while the callback is fine).
+struct CaptureStats {
+    std::atomic<uint64_t> blocks = 0;               // Callbacks, or blocks written for sources without one
+    std::atomic<uint64_t> samples = 0;
+    std::atomic<uint64_t> input_overflows = 0;      // The driver discarded input before we saw it (paInputOverflow)
+    std::atomic<uint64_t> input_underflows = 0;     // The driver padded the input with silence (paInputUnderflow)
+    std::atomic<uint64_t> zero_filled_blocks = 0;   // No input buffer at all, silence written in its place
+    LatencyHistogram callback_time;                 // Spent inside the callback
+    LatencyHistogram callback_gap;                  // From one callback's start to the next one's
+
+    // Callback side: one relaxed add per counter, no allocation
+    static void add(std::atomic<uint64_t> &counter, const uint64_t amount = 1) {
+        counter.fetch_add(amount, std::memory_order_relaxed);
+    }
+
+    void print(std::ostream &out) const;
+};
+
+#endif //CAPTURESTATS_H
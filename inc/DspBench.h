@@ -0,0 +1,29 @@
+//
+// Created by Sebastian Sandstig on 2026-10-17.
+//
+
+#ifndef DSPBENCH_H
+#define DSPBENCH_H
+
+#include <string>
+#include <vector>
+
+// Correctness checks and timings for the DSP path, run before upgrading compilers, FFTW or the engines themselves.
+// Built into the headless `soundscape_tests` (checks, one ctest per group) and `soundscape_bench` (timings)
+// executables, and still reachable as `soundscape --bench [--quick]` for both at once.
+//  - every spectrum engine against a double precision naive DFT, 512 to 65536 points, with the frame split
+//    across both ring pieces
+//  - window normalisation, band mapping (and the compiled-in analyzers against the runtime path)
+//  - capture ring wrap-around, lapped readers and snapshot validity
+//  - per-transform timings of each engine and of band mapping
+// Prints a report and returns EXIT_FAILURE if any check fails. `--quick` stops at 8192 points.
+class DspBench {
+public:
+    // Checks, then timings
+    static int run(const std::vector<std::string> &args);
+    // Only the checks of the named groups (engines, windows, bands, ring, pipeline), all of them if none is named
+    static int check(const std::vector<std::string> &args);
+    static int bench(const std::vector<std::string> &args);
+};
+
+#endif //DSPBENCH_H
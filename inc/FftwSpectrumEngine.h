@@ -0,0 +1,35 @@
+//
+// Created by Sebastian Sandstig on 2026-10-17.
+//
+
+#ifndef FFTWSPECTRUMENGINE_H
+#define FFTWSPECTRUMENGINE_H
+
+#include <fftw3.h>
+
+#include <SpectrumEngine.h>
+
+// FFTW single precision real-to-complex transform. Plans are made once per size with FFTW_MEASURE, shared by all
+// engines of that size and seeded from/saved to the wisdom file so only the first run pays for measuring.
+class FftwSpectrumEngine final : public SpectrumEngine {
+public:
+    explicit FftwSpectrumEngine(size_t size);
+    ~FftwSpectrumEngine() override;
+
+    FftwSpectrumEngine(const FftwSpectrumEngine&) = delete;
+    FftwSpectrumEngine& operator=(const FftwSpectrumEngine&) = delete;
+
+    using SpectrumEngine::transform;
+    [[nodiscard]] Kind kind() const override { return FFTW; }
+    void transform(std::span<const float> older, std::span<const float> newer, std::span<const float> window,
+                   std::span<float> magnitudes) override;
+
+    // $SOUNDSCAPE_FFTW_WISDOM, or ~/.soundscape_fftw_wisdom
+    static std::string wisdom_path();
+private:
+    fftwf_plan m_plan;
+    float *m_input;             // size() reals, SIMD aligned by fftwf_alloc_real
+    fftwf_complex *m_output;    // size() / 2 + 1 bins
+};
+
+#endif //FFTWSPECTRUMENGINE_H
@@ -0,0 +1,38 @@
+//
+// Created by Sebastian Sandstig on 2026-10-17.
+//
+
+#ifndef FILESOURCE_H
+#define FILESOURCE_H
+
+#include <string>
+#include <vector>
+
+#include <BlockSource.h>
+#include <PcmFormat.h>
+
+// Replays a recording as if it were being captured. WAVE files are recognised by their header; anything else is
+// taken as raw PCM in `raw_format` at `raw_sample_rate`. The whole file is decoded up front so replay never touches
+// the disk, and `speed` above 1 (or 0, as fast as possible) profiles the analysis path on the same input every run.
+class FileSource final : public BlockSource {
+public:
+    FileSource(const std::string &path, double speed = 1.0, bool loop = false, PcmFormat raw_format = {},
+               size_t raw_sample_rate = 48000);
+    ~FileSource() override;
+
+    [[nodiscard]] const char* name() const override { return "file"; }
+    [[nodiscard]] size_t sample_rate() const override { return m_sample_rate; }
+    [[nodiscard]] bool is_alive() const override { return !m_samples.empty(); }
+    [[nodiscard]] double duration() const {
+        return static_cast<double>(m_samples.size()) / static_cast<double>(m_sample_rate);
+    }
+protected:
+    size_t produce(float *samples, size_t count) override;
+private:
+    size_t m_sample_rate;
+    bool m_loop;
+    std::vector<float> m_samples;
+    size_t m_cursor = 0;
+};
+
+#endif //FILESOURCE_H
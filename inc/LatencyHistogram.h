@@ -0,0 +1,43 @@
+//
+// Created by Sebastian Sandstig on 2026-10-17.
+//
+
+#ifndef LATENCYHISTOGRAM_H
+#define LATENCYHISTOGRAM_H
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+// Lock-free histogram of durations from 1 us to about a minute, for latency and timing figures that are recorded on
+// one thread (often a real-time one) and read on another. Buckets are log spaced, eight per octave, so any
+// percentile is good to about 9%. Recording is a couple of relaxed atomic adds: no lock, no allocation, safe from an
+// audio callback. Readers see a slightly stale but never torn picture.
+class LatencyHistogram {
+public:
+    using Duration = std::chrono::nanoseconds;
+
+    void record(Duration duration);
+
+    [[nodiscard]] uint64_t count() const { return m_count.load(std::memory_order_relaxed); }
+    [[nodiscard]] Duration max() const { return Duration(m_max.load(std::memory_order_relaxed)); }
+    [[nodiscard]] Duration mean() const;
+    // Upper edge of the bucket holding the `fraction` quantile, 0 while empty
+    [[nodiscard]] Duration percentile(double fraction) const;
+    void reset();
+private:
+    static constexpr size_t SUB_BUCKETS = 8;
+    static constexpr size_t OCTAVES = 26;       // 2^26 us is a bit over a minute
+    static constexpr size_t BUCKET_COUNT = OCTAVES * SUB_BUCKETS;
+
+    std::array<std::atomic<uint64_t>, BUCKET_COUNT> m_buckets {};
+    std::atomic<uint64_t> m_count = 0;
+    std::atomic<int64_t> m_sum = 0;             // Nanoseconds
+    std::atomic<int64_t> m_max = 0;
+
+    static size_t bucket(int64_t microseconds);
+    static int64_t bucket_upper(size_t bucket);
+};
+
+#endif //LATENCYHISTOGRAM_H
@@ -0,0 +1,72 @@
+//
+// Created by Sebastian Sandstig on 2026-10-17.
+//
+
+#ifndef MULTIRESOLUTIONANALYZER_H
+#define MULTIRESOLUTIONANALYZER_H
+
+#include <utility>
+#include <vector>
+
+#include <BandMapper.h>
+#include <CaptureRing.h>
+#include <Stft.h>
+
+struct SpectrumResolution {
+    size_t fft_size;
+    size_t hop_size;
+    float low_frequency;    // Bands centred at or above this may be taken from this transform
+};
+
+// Several STFTs of different lengths over the same ring, stitched into one band vector.
+// Every band is read from the shortest transform that is allowed at its centre frequency and still puts a couple
+// of bins under the band, so highs come from short frames that react within a few milliseconds while bass keeps
+// the long frame's frequency resolution. Bands are ordered by frequency, so each transform owns a contiguous run
+// of them and only that run is recomputed when the transform completes a hop.
+// Each transform reads a sine at its amplitude, so a flat noise floor reads higher the shorter the transform, by the
+// square root of the length ratio, and would step up at every crossover. The shorter transforms' bands are therefore scaled by sqrt(N / N_primary)
+// so broadband content (noise, drums, cymbals) keeps its level across the crossovers; a pure tone in a band taken
+// from a shorter transform reads that much lower than the primary would show it.
+class MultiResolutionAnalyzer {
+public:
+    MultiResolutionAnalyzer(const CaptureRing &ring, size_t sample_rate, std::vector<SpectrumResolution> resolutions,
+                            size_t band_count, float low_frequency, float high_frequency,
+                            BandMapper::Scale scale = BandMapper::MEL, Stft::Window window = Stft::HANN,
+                            SpectrumEngine::Kind engine = SpectrumEngine::DEFAULT_KIND);
+
+    [[nodiscard]] size_t resolution_count() const { return m_resolutions.size(); }
+    [[nodiscard]] const Stft& stft(size_t resolution) const { return m_resolutions[resolution].stft; }
+    // The longest transform, the finest frequency resolution
+    [[nodiscard]] const Stft& primary() const { return m_resolutions.front().stft; }
+    // Bands [first, last) taken from a resolution
+    [[nodiscard]] std::pair<size_t, size_t> band_range(size_t resolution) const {
+        return {m_resolutions[resolution].first_band, m_resolutions[resolution].last_band};
+    }
+
+    [[nodiscard]] size_t band_count() const { return m_band_energies.size(); }
+    [[nodiscard]] const std::vector<float>& band_energies() const { return m_band_energies; }
+    // Ring cursor one past the newest sample that went into `band_energies()`
+    [[nodiscard]] uint64_t frame_end() const { return m_frame_end; }
+
+    // Advances every transform that has a new hop and refreshes its bands. Returns false if none had.
+    bool update();
+    // Rebuilds the band tables; allocates
+    void set_band_count(size_t band_count);
+private:
+    struct Resolution {
+        Stft stft;
+        BandMapper bands;
+        float low_frequency;
+        float gain;                         // sqrt(fft_size / primary fft_size), matches the broadband level
+        size_t first_band = 0;
+        size_t last_band = 0;
+    };
+
+    std::vector<Resolution> m_resolutions;  // Longest transform first
+    std::vector<float> m_band_energies;
+    uint64_t m_frame_end = 0;
+
+    void assign_bands();
+};
+
+#endif //MULTIRESOLUTIONANALYZER_H
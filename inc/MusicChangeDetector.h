@@ -0,0 +1,57 @@
+//
+// Created by Sebastian Sandstig on 2026-10-17.
+//
+
+#ifndef MUSICCHANGEDETECTOR_H
+#define MUSICCHANGEDETECTOR_H
+
+#include <array>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+// What the renderer and the recognizer see of the music change detector, published with every analysis frame.
+// Like BeatState's, changes are a counter: compare with the last value seen to learn whether one happened.
+struct MusicChangeState {
+    float level = -120.0f;          // Loudness of the newest hop in dB, 0 for a full-scale sine
+    bool silent = true;
+    float novelty = 0.0f;           // Cosine distance of the recent chroma from the current piece's, [0, 1]
+    uint64_t change_count = 0;      // Times the music has likely changed: a new song, or sound after silence
+};
+
+// Tells when whatever is playing has likely been replaced by something else, so song recognition only runs when
+// there is something new to recognise. Per hop of the long STFT the magnitudes are folded into a 12-bin chroma
+// (pitch class profile) and a loudness level. A slow average of the chroma since the last change stands for the
+// current piece and a fast one for what is playing now; a change fires when the two stay far apart for a couple of
+// seconds, or when sound returns after a gap of silence. Preallocated: `process` is O(bins), no allocation.
+class MusicChangeDetector {
+public:
+    // `bin_width` is the STFT's bin spacing in Hz, `frame_rate` its hops per second
+    MusicChangeDetector(size_t bin_count, float bin_width, float frame_rate);
+
+    [[nodiscard]] const MusicChangeState& state() const { return m_state; }
+
+    // Feeds one hop worth of magnitudes (normalised, see Stft), `bin_count` of them. True if a change fired.
+    bool process(std::span<const float> magnitudes);
+private:
+    using Chroma = std::array<float, 12>;
+
+    float m_frame_rate;
+    std::vector<int8_t> m_pitch_class;  // Per bin, -1 outside the range that carries pitch
+    float m_recent_decay;
+    float m_piece_decay;
+
+    Chroma m_recent {};                 // Fast average of normalised chroma, what is playing now
+    Chroma m_piece {};                  // Slow average since the last change, what has been playing
+    size_t m_silent_hops = 0;
+    size_t m_sound_hops = 0;
+    size_t m_novel_hops = 0;            // Consecutive hops with novelty above the threshold
+    size_t m_hops_since_change = 0;
+    bool m_gap = false;                 // Silence long enough to count as the end of a piece
+    MusicChangeState m_state;
+
+    [[nodiscard]] size_t hops(float seconds) const;
+    void fire();
+};
+
+#endif //MUSICCHANGEDETECTOR_H
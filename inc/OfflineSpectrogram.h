@@ -0,0 +1,71 @@
+//
+// Created by Sebastian Sandstig on 2026-10-17.
+//
+
+#ifndef OFFLINESPECTROGRAM_H
+#define OFFLINESPECTROGRAM_H
+
+#include <cstdint>
+#include <span>
+#include <string>
+
+#include <BandMapper.h>
+#include <SpectrumEngine.h>
+#include <Stft.h>
+
+struct SpectrogramSettings {
+    size_t fft_size = 8192;
+    size_t hop_size = 512;
+    Stft::Window window = Stft::HANN;
+    SpectrumEngine::Kind spectrum_engine = SpectrumEngine::DEFAULT_KIND;
+    size_t band_count = 16;
+    float band_low_frequency = 30.0f;
+    float band_high_frequency = 10000.0f;
+    BandMapper::Scale band_scale = BandMapper::MEL;
+    size_t thread_count = 0;        // 0 uses every hardware thread
+    size_t frames_per_chunk = 64;   // Frames handed to a worker at a time
+    // Use a compiled-in SpectrumAnalyzer when one matches (Hann, mel, integer band edges), see SpectrumAnalyzerRegistry
+    bool prefer_static_analyzer = false;
+};
+
+// Whole-file STFT + band energies, spread over a thread pool and written straight into a memory-mapped file.
+// Frames are laid out like the live Stft: frame f covers the fft_size samples ending at (f + 1) * hop_size, with
+// samples before the start and after the end of the input read as silence, so there are ceil(samples / hop)
+// frames. Chunks of consecutive frames overlap in the input by fft_size - hop_size samples and share nothing else;
+// every worker owns its own spectrum engine and writes its frames' rows directly into the mapping. Rows are padded
+// to whole cache lines, so workers writing neighbouring frames never share one.
+//
+// File layout (little endian on every platform this builds for):
+//   Header, padded to `magnitudes_offset`
+//   frame_count rows of bin_stride floats     normalised magnitudes (the first bin_count), see Stft
+//   frame_count rows of band_stride floats    band energies (the first band_count), see BandMapper
+// Padding floats are zero.
+class OfflineSpectrogram {
+public:
+    struct Header {
+        char magic[8];              // "SSSPECT\0"
+        uint32_t version;
+        uint32_t sample_rate;
+        uint32_t fft_size;
+        uint32_t hop_size;
+        uint32_t bin_count;
+        uint32_t band_count;
+        uint32_t window;            // Stft::Window
+        uint32_t band_scale;        // BandMapper::Scale
+        float band_low_frequency;
+        float band_high_frequency;
+        uint32_t bin_stride;        // Floats from one magnitude row to the next
+        uint32_t band_stride;       // Floats from one band row to the next
+        uint64_t frame_count;
+        uint64_t magnitudes_offset;
+        uint64_t bands_offset;
+    };
+
+    static constexpr uint32_t VERSION = 2;
+
+    // Returns the header that was written
+    static Header render(std::span<const float> samples, size_t sample_rate, const std::string &output_path,
+                         const SpectrogramSettings &settings = {});
+};
+
+#endif //OFFLINESPECTROGRAM_H
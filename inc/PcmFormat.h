@@ -0,0 +1,37 @@
+//
+// Created by Sebastian Sandstig on 2026-10-17.
+//
+
+#ifndef PCMFORMAT_H
+#define PCMFORMAT_H
+
+#include <cstdint>
+#include <optional>
+#include <string>
+
+// Layout of interleaved little-endian PCM, as found in WAVE data chunks and raw streams (`arecord -t raw`, sox, ...)
+struct PcmFormat {
+    enum Encoding {
+        U8 = 0,     // Unsigned, 128 is silence
+        S16,
+        S24,        // Packed, three bytes per sample
+        S32,
+        F32,
+        F64
+    };
+
+    Encoding encoding = S16;
+    size_t channel_count = 1;
+
+    [[nodiscard]] size_t bytes_per_sample() const;
+    [[nodiscard]] size_t bytes_per_frame() const { return bytes_per_sample() * channel_count; }
+
+    // Decodes `frame_count` frames to mono floats in [-1, 1], averaging the channels. Consecutive frames start
+    // `frame_stride` bytes apart, 0 meaning tightly packed.
+    void decode(const uint8_t *bytes, size_t frame_count, float *samples, size_t frame_stride = 0) const;
+
+    static const char* encoding_name(Encoding encoding);
+    static std::optional<Encoding> parse_encoding(const std::string &name);
+};
+
+#endif //PCMFORMAT_H
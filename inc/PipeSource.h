@@ -0,0 +1,46 @@
+//
+// Created by Sebastian Sandstig on 2026-10-17.
+//
+
+#ifndef PIPESOURCE_H
+#define PIPESOURCE_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include <BlockSource.h>
+#include <PcmFormat.h>
+
+// Raw PCM streamed in over stdin ("-") or a named pipe, e.g. from a mixing desk on a headless box:
+//   arecord -t raw -f S16_LE -c 2 -r 48000 | soundscape --source - --channels 2
+// The writer sets the pace, so samples go into the ring as soon as whole frames have arrived. When the writer of a
+// named pipe goes away the pipe is reopened and waits for the next one; end of stdin ends the source.
+class PipeSource final : public BlockSource {
+public:
+    PipeSource(const std::string &path, size_t sample_rate, PcmFormat format = {});
+    ~PipeSource() override;
+
+    [[nodiscard]] const char* name() const override { return "pipe"; }
+    [[nodiscard]] size_t sample_rate() const override { return m_sample_rate; }
+    [[nodiscard]] bool is_alive() const override { return m_fd >= 0; }
+protected:
+    size_t produce(float *samples, size_t count) override;
+    void wake() override;
+private:
+    std::string m_path;
+    size_t m_sample_rate;
+    PcmFormat m_format;
+    bool m_fifo = false;
+    int m_fd = -1;
+    int m_wake_pipe[2] = {-1, -1};      // Written by `wake` to get `produce` out of poll()
+
+    std::vector<uint8_t> m_bytes;       // Bytes read but not yet decoded, a partial frame at most after `produce`
+    size_t m_pending = 0;
+
+    bool open_input();
+    // Waits on the wake pipe alone for up to `timeout_ms`; true if woken
+    bool wait_for_wake(int timeout_ms);
+};
+
+#endif //PIPESOURCE_H
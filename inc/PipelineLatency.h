@@ -0,0 +1,50 @@
+//
+// Created by Sebastian Sandstig on 2026-10-17.
+//
+
+#ifndef PIPELINELATENCY_H
+#define PIPELINELATENCY_H
+
+#include <array>
+#include <chrono>
+#include <ostream>
+
+#include <LatencyHistogram.h>
+
+// Where the time goes between a sound reaching the input and the bars showing it, one histogram per stage:
+//  CAPTURE   ADC timestamp of the newest sample -> the analysis thread picks the block up
+//  ANALYSIS  pickup -> spectrum and bands published
+//  UPDATE    published -> the render loop has written the bars for it
+//  PRESENT   bars written -> vkQueuePresentKHR returned (frame pacing, command recording, submit, present)
+//  GPU       vkQueueSubmit -> the frame's fence was seen signalled; an upper bound when the fence was already done
+//  TOTAL     ADC -> vkQueuePresentKHR returned. Scan-out comes after that, up to a refresh later.
+// All but GPU are recorded once per spectrum, on the first rendered frame that shows it; GPU for every frame.
+class PipelineLatency {
+public:
+    enum Stage {
+        CAPTURE = 0,
+        ANALYSIS,
+        UPDATE,
+        PRESENT,
+        GPU,
+        TOTAL,
+        STAGE_COUNT
+    };
+
+    void record(const Stage stage, const std::chrono::steady_clock::duration duration) {
+        m_stages[stage].record(std::chrono::duration_cast<LatencyHistogram::Duration>(duration));
+    }
+    [[nodiscard]] const LatencyHistogram& histogram(const Stage stage) const { return m_stages[stage]; }
+    void reset() {
+        for (auto &stage : m_stages) stage.reset();
+    }
+
+    // One line per stage: count, p50, p90, p99 and max in milliseconds
+    void print(std::ostream &out) const;
+
+    static const char* stage_name(Stage stage);
+private:
+    std::array<LatencyHistogram, STAGE_COUNT> m_stages;
+};
+
+#endif //PIPELINELATENCY_H
@@ -0,0 +1,129 @@
+//
+// Created by Sebastian Sandstig on 2026-10-17.
+//
+
+#ifndef PORTAUDIOSOURCE_H
+#define PORTAUDIOSOURCE_H
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <vector>
+
+#include <portaudio.h>
+
+#include <AudioSource.h>
+#include <CaptureRing.h>
+#include <CaptureStats.h>
+#include <ThreadTuning.h>
+
+class AudioRecordCallback {
+public:
+    AudioRecordCallback(const std::shared_ptr<CaptureRing> &ring, const size_t sample_rate, CaptureStats &stats,
+                        ThreadPolicy thread_policy)
+        : m_ring(ring), m_sample_period(1.0 / static_cast<double>(sample_rate)), m_stats(stats),
+        m_thread_tuning("audio", std::move(thread_policy)), m_continue_recording(true) {}
+    ~AudioRecordCallback() = default;
+    // Runs on the PortAudio thread: must not block or allocate
+    int callback(const void *input_buffer, void *output_buffer,
+                           const unsigned long frames_per_buffer,
+                           const PaStreamCallbackTimeInfo* time_info,
+                           PaStreamCallbackFlags status_flags)
+    {
+        // The thread is PortAudio's and only reachable from in here. The first buffer makes the system calls for
+        // a non-default policy; the report is written off this thread.
+        m_thread_tuning.apply();
+        const auto start = std::chrono::steady_clock::now();
+        if (m_last_callback != std::chrono::steady_clock::time_point{}) {
+            m_stats.callback_gap.record(start - m_last_callback);
+        }
+        m_last_callback = start;
+        if (status_flags & paInputOverflow) CaptureStats::add(m_stats.input_overflows);
+        if (status_flags & paInputUnderflow) CaptureStats::add(m_stats.input_underflows);
+        // The ring writes silence for a null buffer, which keeps the timeline intact but has to be visible
+        if (input_buffer == nullptr) CaptureStats::add(m_stats.zero_filled_blocks);
+
+        m_ring->write(static_cast<const float *>(input_buffer), frames_per_buffer,
+                      capture_time(time_info, frames_per_buffer));
+        CaptureStats::add(m_stats.blocks);
+        CaptureStats::add(m_stats.samples, frames_per_buffer);
+        m_stats.callback_time.record(std::chrono::steady_clock::now() - start);
+
+        if (m_continue_recording.load(std::memory_order_relaxed))
+            return paContinue;
+
+        return paComplete;
+    }
+
+    // Copies the newest output->size() samples, oldest first
+    void get_buffer(std::vector<float>* output) const {
+        // A torn copy means the callback lapped us mid-read, the next try sees a consistent ring
+        while (!m_ring->read_latest(output->data(), output->size())) {}
+    }
+    void stop_recording() {
+        m_continue_recording.store(false, std::memory_order_relaxed);
+    }
+    [[nodiscard]] bool stopped_recording() const {
+        return !m_continue_recording.load(std::memory_order_relaxed);
+    }
+private:
+    std::shared_ptr<CaptureRing> m_ring;
+    double m_sample_period;
+    CaptureStats &m_stats;
+    ThreadTuning::Deferred m_thread_tuning;
+    std::chrono::steady_clock::time_point m_last_callback;      // Only touched by the callback
+    std::atomic<bool> m_continue_recording;
+
+    // ADC time of the block's last sample on the steady clock. PortAudio reports it on the stream's own clock, so
+    // it is carried over through how long ago it was relative to the stream's `currentTime`.
+    [[nodiscard]] std::chrono::steady_clock::time_point capture_time(const PaStreamCallbackTimeInfo *time_info,
+                                                                     const unsigned long frames) const {
+        const auto now = std::chrono::steady_clock::now();
+        // Some host APIs leave the times at 0
+        if (time_info == nullptr || time_info->inputBufferAdcTime <= 0.0 || time_info->currentTime <= 0.0) return now;
+        const double age = time_info->currentTime - time_info->inputBufferAdcTime -
+                           static_cast<double>(std::max(frames, 1UL) - 1) * m_sample_period;
+        return now - std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+                         std::chrono::duration<double>(std::max(age, 0.0)));
+    }
+};
+
+// The default input device through PortAudio, mono float32
+class PortAudioSource final : public AudioSource {
+public:
+    // 0 opens the device at its native rate
+    explicit PortAudioSource(size_t sample_rate = 0);
+    ~PortAudioSource() override;
+
+    PortAudioSource(const PortAudioSource&) = delete;
+    PortAudioSource& operator=(const PortAudioSource&) = delete;
+
+    [[nodiscard]] const char* name() const override { return "portaudio"; }
+    [[nodiscard]] size_t sample_rate() const override { return m_sample_rate; }
+    [[nodiscard]] bool is_alive() const override { return m_is_alive; }
+    [[nodiscard]] bool is_active() const override;
+
+    bool start(const std::shared_ptr<CaptureRing> &ring, size_t frame_size) override;
+    void stop() override;
+private:
+    size_t m_sample_rate;
+    PaError m_err = paNoError;
+    PaStreamParameters m_input_parameters{};
+    std::atomic<PaStream*> m_stream = nullptr;
+    bool m_is_alive = true;
+
+    AudioRecordCallback* m_arc = nullptr;
+
+    static int callback(const void *input_buffer, void *output_buffer,
+                           const unsigned long frames_per_buffer,
+                           const PaStreamCallbackTimeInfo* time_info,
+                           PaStreamCallbackFlags status_flags,
+                           void *user_data)
+    {
+        const auto arc = static_cast<AudioRecordCallback*>(user_data);
+        return arc->callback(input_buffer, output_buffer, frames_per_buffer, time_info, status_flags);
+    }
+};
+
+#endif //PORTAUDIOSOURCE_H
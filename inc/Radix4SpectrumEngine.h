@@ -0,0 +1,55 @@
+//
+// Created by Sebastian Sandstig on 2026-10-17.
+//
+
+#ifndef RADIX4SPECTRUMENGINE_H
+#define RADIX4SPECTRUMENGINE_H
+
+#include <cstdint>
+
+#include <SpectrumEngine.h>
+
+// Built-in real FFT for builds without FFTW.
+// The N real samples are packed as N/2 complex values, permuted by a precomputed bit-reversal table into split
+// (separate real/imaginary) arrays and transformed with radix-4 butterflies (plus one radix-2 pass when log2(N/2)
+// is odd) using per-stage twiddle tables. A final pass untangles the N/2-point complex result into the real
+// spectrum. The butterfly kernel is picked at construction from what the CPU supports: AVX2+FMA, SSE2, NEON or scalar.
+class Radix4SpectrumEngine final : public SpectrumEngine {
+public:
+    explicit Radix4SpectrumEngine(size_t size);
+
+    using SpectrumEngine::transform;
+    [[nodiscard]] Kind kind() const override { return RADIX4; }
+    void transform(std::span<const float> older, std::span<const float> newer, std::span<const float> window,
+                   std::span<float> magnitudes) override;
+
+    // Name of the butterfly kernel picked for this CPU
+    [[nodiscard]] const char* kernel_name() const { return m_kernel_name; }
+
+    // One radix-4 stage over all blocks of `4 * quarter` points. `twiddles` holds the stage's W^2j, W^j and W^3j
+    // tables as six runs of `quarter` floats: re, im, re, im, re, im.
+    using Radix4Stage = void (*)(float *re, float *im, size_t count, size_t quarter, const float *twiddles);
+private:
+    struct Stage {
+        size_t quarter;
+        size_t twiddle_offset;
+    };
+
+    size_t m_half;                          // Complex points, size() / 2
+    std::vector<uint32_t> m_bit_reverse;
+    std::vector<Stage> m_stages;
+    std::vector<float> m_twiddles;
+    std::vector<float> m_real_twiddle_re;   // W_N^k, k < N / 2, for the real-spectrum split
+    std::vector<float> m_real_twiddle_im;
+    std::vector<float> m_re;
+    std::vector<float> m_im;
+    std::vector<float> m_unit_window;       // Stand-in when no window is given
+
+    Radix4Stage m_radix4_stage;
+    const char* m_kernel_name;
+
+    void load(std::span<const float> older, std::span<const float> newer, std::span<const float> window);
+    void radix2_pass();
+};
+
+#endif //RADIX4SPECTRUMENGINE_H
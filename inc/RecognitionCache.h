@@ -0,0 +1,92 @@
+//
+// Created by Sebastian Sandstig on 2026-10-17.
+//
+
+#ifndef RECOGNITIONCACHE_H
+#define RECOGNITIONCACHE_H
+
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <ostream>
+#include <string>
+#include <unordered_map>
+
+// What the renderer needs of a Shazam match, pulled out of the response once
+struct RecognizedTrack {
+    std::string key;                // Shazam's track id, stable across fingerprints of the same recording
+    std::string title;
+    std::string subtitle;           // Usually the artist
+    std::string cover_art;          // Empty if the track has none
+    std::string joe_color;          // Shazam's raw "joecolor" palette string, empty if none
+
+    bool operator==(const RecognizedTrack&) const = default;
+};
+
+// Recognition results by fingerprint signature and by track id. A bounded LRU in memory fronts an append-only file
+// of tracks that is memory-mapped when opened, so a restart starts out knowing every track seen before. Fingerprint
+// signatures are only kept in memory: two captures of the same song hardly ever produce the same one, while a track
+// id repeats every time it plays. Thread-safe.
+class RecognitionCache {
+public:
+    struct Counters {
+        uint64_t hits = 0;              // Found in memory
+        uint64_t disk_hits = 0;         // Found in the file and brought back into memory
+        uint64_t misses = 0;
+        uint64_t evictions = 0;         // Dropped from memory to stay within the capacity
+        uint64_t stored_tracks = 0;     // Distinct tracks in the file
+    };
+
+    // `capacity` entries in memory (a fingerprint and a track id count one each). An empty `path` keeps everything
+    // in memory; otherwise the file is created if needed, and a cache that cannot be opened is reported and runs
+    // memory-only rather than failing recognition.
+    explicit RecognitionCache(size_t capacity = 256, const std::string &path = "");
+    ~RecognitionCache();
+
+    RecognitionCache(const RecognitionCache&) = delete;
+    RecognitionCache& operator=(const RecognitionCache&) = delete;
+
+    [[nodiscard]] std::optional<RecognizedTrack> find_fingerprint(const std::string &signature);
+    [[nodiscard]] std::optional<RecognizedTrack> find_track(const std::string &key);
+    // Remembers `track` under `signature` and its id. Only a track new to the file, or one whose details changed,
+    // is appended to it.
+    void insert(const std::string &signature, const RecognizedTrack &track);
+
+    [[nodiscard]] Counters counters() const;
+    [[nodiscard]] const std::string& path() const { return m_path; }
+    void print(std::ostream &out) const;
+
+    // $XDG_CACHE_HOME/soundscape/recognitions, falling back to ~/.cache; empty if neither is set
+    static std::string default_path();
+private:
+    using Entry = std::pair<uint64_t, std::shared_ptr<const RecognizedTrack>>;
+
+    size_t m_capacity;
+    std::string m_path;
+    mutable std::mutex m_mutex;
+
+    // Most recently used first
+    std::list<Entry> m_lru;
+    std::unordered_map<uint64_t, std::list<Entry>::iterator> m_entries;
+
+    // The file: appended to through m_fd, read through the mapping of its first m_mapped_size bytes
+    int m_fd = -1;
+    const char *m_map = nullptr;
+    size_t m_mapped_size = 0;
+    size_t m_file_size = 0;
+    std::unordered_map<uint64_t, size_t> m_records;     // Track id hash -> offset of its newest record
+
+    Counters m_counters;
+
+    std::optional<RecognizedTrack> find(uint64_t hash);
+    void remember(uint64_t hash, const std::shared_ptr<const RecognizedTrack> &track);
+    void open_file();
+    bool remap();
+    void append(uint64_t hash, const RecognizedTrack &track);
+    // The track in the record at `offset` if it is intact and stored under `expected_hash`
+    [[nodiscard]] std::optional<RecognizedTrack> read_record(size_t offset, uint64_t expected_hash) const;
+};
+
+#endif //RECOGNITIONCACHE_H
@@ -0,0 +1,45 @@
+//
+// Created by Sebastian Sandstig on 2026-10-17.
+//
+
+#ifndef RESAMPLER_H
+#define RESAMPLER_H
+
+#include <cstddef>
+#include <vector>
+
+// Streaming rational-ratio resampler (polyphase windowed-sinc FIR).
+// Converts `input_rate` to `output_rate` by upsampling with L = output / gcd and decimating with M = input / gcd,
+// only ever evaluating the taps of the phase that lands on an output sample. Equal rates pass samples through.
+class Resampler {
+public:
+    Resampler(size_t input_rate, size_t output_rate, size_t taps_per_phase = 32);
+    ~Resampler() = default;
+
+    [[nodiscard]] size_t input_rate() const { return m_input_rate; }
+    [[nodiscard]] size_t output_rate() const { return m_output_rate; }
+    // Upper bound on the samples `process` can produce for `input_count` input samples
+    [[nodiscard]] size_t max_output(size_t input_count) const;
+
+    // Consumes `count` samples and writes the produced samples to `out`, returning how many were written.
+    // `out` must hold at least `max_output(count)` samples.
+    size_t process(const float *in, size_t count, float *out);
+    void reset();
+private:
+    size_t m_input_rate;
+    size_t m_output_rate;
+    size_t m_up;    // L
+    size_t m_down;  // M
+    size_t m_taps;  // Taps per phase
+
+    // m_up phases of m_taps coefficients, each stored reversed so a phase is a forward dot product over the input
+    std::vector<float> m_coefficients;
+    // Last m_taps - 1 input samples followed by the block being processed
+    std::vector<float> m_work;
+    // Position of the next output sample in units of 1/L input samples, relative to the current block
+    size_t m_next = 0;
+
+    void design_filter();
+};
+
+#endif //RESAMPLER_H
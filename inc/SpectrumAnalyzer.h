@@ -0,0 +1,330 @@
+//
+// Created by Sebastian Sandstig on 2026-10-17.
+//
+
+#ifndef SPECTRUMANALYZER_H
+#define SPECTRUMANALYZER_H
+
+#include <array>
+#include <bit>
+#include <cmath>
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <utility>
+#include <vector>
+
+// Just enough constexpr math to build FFT, window and filter tables at compile time (std::cos and friends are
+// not constexpr in C++20). Double precision, accurate to well below float rounding over the ranges used here.
+namespace static_math {
+    constexpr double PI = 3.14159265358979323846;
+    constexpr double LN2 = 0.69314718055994530942;
+    constexpr double LN10 = 2.30258509299404568402;
+
+    constexpr double cos(double x);
+
+    constexpr double sin(double x) {
+        // Reduce to [-pi, pi], then fold onto [-pi/2, pi/2] where the series converges quickly
+        x -= 2.0 * PI * static_cast<double>(static_cast<int64_t>(x / (2.0 * PI)));
+        if (x > PI) x -= 2.0 * PI;
+        if (x < -PI) x += 2.0 * PI;
+        if (x > PI / 2) x = PI - x;
+        if (x < -PI / 2) x = -PI - x;
+        double term = x;
+        double sum = x;
+        for (int n = 1; n < 12; n++) {
+            term *= -x * x / static_cast<double>((2 * n) * (2 * n + 1));
+            sum += term;
+        }
+        return sum;
+    }
+
+    constexpr double cos(const double x) { return sin(x + PI / 2); }
+
+    constexpr double exp(const double x) {
+        // e^x = 2^k e^r with |r| <= ln2 / 2
+        const auto k = static_cast<int64_t>(x / LN2 + (x < 0 ? -0.5 : 0.5));
+        const double r = x - static_cast<double>(k) * LN2;
+        double term = 1.0;
+        double sum = 1.0;
+        for (int n = 1; n < 16; n++) {
+            term *= r / static_cast<double>(n);
+            sum += term;
+        }
+        for (int64_t i = 0; i < k; i++) sum *= 2.0;
+        for (int64_t i = 0; i > k; i--) sum /= 2.0;
+        return sum;
+    }
+
+    constexpr double log(double x) {
+        // x = m 2^e with m in [1, 2), ln m = 2 atanh((m - 1) / (m + 1))
+        int e = 0;
+        while (x >= 2.0) { x /= 2.0; e++; }
+        while (x < 1.0) { x *= 2.0; e--; }
+        const double y = (x - 1.0) / (x + 1.0);
+        double term = y;
+        double sum = 0.0;
+        for (int n = 1; n < 40; n += 2) {
+            sum += term / static_cast<double>(n);
+            term *= y * y;
+        }
+        return 2.0 * sum + static_cast<double>(e) * LN2;
+    }
+
+    constexpr double to_mel(const double frequency) { return 2595.0 / LN10 * log(1.0 + frequency / 700.0); }
+    constexpr double from_mel(const double mel) { return 700.0 * (exp(mel * LN10 / 2595.0) - 1.0); }
+}
+
+// Compile-time tables for SpectrumAnalyzer
+namespace static_tables {
+    template<size_t N>
+    struct Fft {
+        static constexpr size_t HALF = N / 2;
+        std::array<uint32_t, HALF> bit_reverse{};
+        std::array<float, HALF> twiddle_re{};   // W_N^k = e^(-2 pi i k / N), k < N / 2
+        std::array<float, HALF> twiddle_im{};
+        // Each butterfly stage's twiddles laid out contiguously: stage `half` starts at half - 1
+        std::array<float, HALF> stage_re{};
+        std::array<float, HALF> stage_im{};
+        std::array<float, N> window{};          // Periodic Hann with the 2 / sum(w) normalisation folded in
+    };
+
+    struct Band {
+        uint32_t first_bin;
+        uint32_t weight_offset;
+        uint32_t weight_count;
+    };
+
+    template<size_t N, size_t Bars>
+    struct Bands {
+        // Neighbouring triangles overlap at most pairwise, plus one fallback bin per band
+        static constexpr size_t MAX_WEIGHTS = N + Bars;
+        std::array<Band, Bars> bands{};
+        std::array<float, MAX_WEIGHTS> weights{};
+    };
+
+    template<size_t N>
+    constexpr Fft<N> make_fft() {
+        constexpr size_t half = N / 2;
+        constexpr size_t log2_half = std::countr_zero(half);
+        Fft<N> tables;
+        for (size_t i = 0; i < half; i++) {
+            uint32_t reversed = 0;
+            for (size_t bit = 0; bit < log2_half; bit++) {
+                reversed |= ((i >> bit) & 1u) << (log2_half - 1 - bit);
+            }
+            tables.bit_reverse[i] = reversed;
+            const double angle = -2.0 * static_math::PI * static_cast<double>(i) / static_cast<double>(N);
+            tables.twiddle_re[i] = static_cast<float>(static_math::cos(angle));
+            tables.twiddle_im[i] = static_cast<float>(static_math::sin(angle));
+        }
+        for (size_t stage_half = 1; stage_half < half; stage_half *= 2) {
+            for (size_t j = 0; j < stage_half; j++) {
+                tables.stage_re[stage_half - 1 + j] = tables.twiddle_re[j * (N / (2 * stage_half))];
+                tables.stage_im[stage_half - 1 + j] = tables.twiddle_im[j * (N / (2 * stage_half))];
+            }
+        }
+        // Hann sums to exactly N / 2, so the normalisation is 4 / N
+        for (size_t n = 0; n < N; n++) {
+            const double phase = 2.0 * static_math::PI * static_cast<double>(n) / static_cast<double>(N);
+            tables.window[n] = static_cast<float>((0.5 - 0.5 * static_math::cos(phase)) * 4.0 / static_cast<double>(N));
+        }
+        return tables;
+    }
+
+    // Mirrors BandMapper::build for the MEL scale
+    template<size_t N, size_t Bars, size_t SampleRate, size_t LowHz, size_t HighHz>
+    constexpr Bands<N, Bars> make_mel_bands() {
+        constexpr size_t bins = N / 2;
+        Bands<N, Bars> result;
+        const double low = static_math::to_mel(static_cast<double>(LowHz));
+        const double high = static_math::to_mel(static_cast<double>(HighHz));
+        const double step = (high - low) / static_cast<double>(Bars + 1);
+        const double bin_width = static_cast<double>(SampleRate) / static_cast<double>(N);
+
+        size_t offset = 0;
+        for (size_t band = 0; band < Bars; band++) {
+            const double lower = static_math::from_mel(low + step * static_cast<double>(band));
+            const double center = static_math::from_mel(low + step * static_cast<double>(band + 1));
+            const double upper = static_math::from_mel(low + step * static_cast<double>(band + 2));
+
+            size_t first = bins;
+            size_t count = 0;
+            double sum = 0.0;
+            for (size_t bin = 0; bin < bins; bin++) {
+                const double frequency = static_cast<double>(bin) * bin_width;
+                if (frequency <= lower || frequency >= upper) continue;
+                const double w = frequency < center ? (frequency - lower) / (center - lower)
+                                                    : (upper - frequency) / (upper - center);
+                if (first == bins) first = bin;
+                result.weights[offset + count++] = static_cast<float>(w);
+                sum += w;
+            }
+            if (count == 0) {
+                // Narrower than a bin: the bin nearest the centre
+                first = static_cast<size_t>(center / bin_width + 0.5);
+                if (first >= bins) first = bins - 1;
+                result.weights[offset] = 1.0f;
+                count = 1;
+                sum = 1.0;
+            }
+            for (size_t i = 0; i < count; i++) {
+                result.weights[offset + i] = static_cast<float>(result.weights[offset + i] / sum);
+            }
+            result.bands[band] = Band {
+                static_cast<uint32_t>(first), static_cast<uint32_t>(offset), static_cast<uint32_t>(count)
+            };
+            offset += count;
+        }
+        return result;
+    }
+}
+
+// A spectrum analyzer whose configuration is baked in at compile time, see SpectrumAnalyzer
+class StaticAnalyzer {
+public:
+    virtual ~StaticAnalyzer() = default;
+
+    [[nodiscard]] virtual size_t fft_size() const = 0;
+    [[nodiscard]] virtual size_t bar_count() const = 0;
+    [[nodiscard]] virtual size_t sample_rate() const = 0;
+    [[nodiscard]] virtual float low_frequency() const = 0;
+    [[nodiscard]] virtual float high_frequency() const = 0;
+    [[nodiscard]] size_t bin_count() const { return fft_size() / 2; }
+
+    // Same contract as SpectrumEngine::transform with a Hann window, plus mel band energies as BandMapper computes
+    // them. `magnitudes` holds bin_count() floats, `bars` bar_count().
+    virtual void analyze(std::span<const float> older, std::span<const float> newer, std::span<float> magnitudes,
+                         std::span<float> bars) = 0;
+};
+
+// Hann-windowed real FFT of N points folded into Bars mel bands between LowHz and HighHz at SampleRate.
+// Bit-reversal, twiddle, window and band weight tables are all constexpr, so a specialization carries them in
+// read-only data instead of building them at start-up, and every loop bound is a constant: the per-stage loop is
+// expanded by a fold over the stage sizes and the compiler is free to unroll and vectorize the butterflies of each.
+// Results match the runtime path (Radix4/FFTW engine + Stft::make_scaled_window(HANN) + BandMapper MEL) to float
+// rounding.
+template<size_t N, size_t Bars, size_t SampleRate = 24000, size_t LowHz = 30, size_t HighHz = 10000>
+class SpectrumAnalyzer final : public StaticAnalyzer {
+    static_assert(std::has_single_bit(N) && N >= 16, "N must be a power of two");
+    static_assert(Bars > 0, "At least one bar");
+    static_assert(0 < LowHz && LowHz < HighHz, "Need 0 < LowHz < HighHz");
+public:
+    static constexpr size_t BINS = N / 2;
+    static constexpr size_t HALF = N / 2;       // Complex points of the packed transform
+    static constexpr size_t LOG2_HALF = std::countr_zero(HALF);
+    static constexpr size_t HIGH = HighHz * 2 <= SampleRate ? HighHz : SampleRate / 2;
+
+    [[nodiscard]] size_t fft_size() const override { return N; }
+    [[nodiscard]] size_t bar_count() const override { return Bars; }
+    [[nodiscard]] size_t sample_rate() const override { return SampleRate; }
+    [[nodiscard]] float low_frequency() const override { return static_cast<float>(LowHz); }
+    [[nodiscard]] float high_frequency() const override { return static_cast<float>(HIGH); }
+
+    void analyze(const std::span<const float> older, const std::span<const float> newer,
+                 const std::span<float> magnitudes, const std::span<float> bars) override
+    {
+        load(older, newer);
+        [this]<size_t... Stage>(std::index_sequence<Stage...>) {
+            (butterflies<size_t{1} << Stage>(), ...);
+        }(std::make_index_sequence<LOG2_HALF>{});
+        split(magnitudes);
+        apply_bands(magnitudes, bars);
+    }
+
+private:
+    static constexpr auto TABLES = static_tables::make_fft<N>();
+    static constexpr auto BANDS = static_tables::make_mel_bands<N, Bars, SampleRate, LowHz, HIGH>();
+
+    std::vector<float> m_re = std::vector<float>(HALF);
+    std::vector<float> m_im = std::vector<float>(HALF);
+
+    void load(const std::span<const float> older, const std::span<const float> newer) {
+        const auto sample = [&](const size_t n) { return n < older.size() ? older[n] : newer[n - older.size()]; };
+        for (size_t i = 0; i < HALF; i++) {
+            const size_t target = TABLES.bit_reverse[i];
+            m_re[target] = sample(2 * i) * TABLES.window[2 * i];
+            m_im[target] = sample(2 * i + 1) * TABLES.window[2 * i + 1];
+        }
+    }
+
+    // One radix-2 stage over blocks of 2 * Half points; twiddle j of the stage is W_N^(j N / (2 Half))
+    template<size_t Half>
+    void butterflies() {
+        float *re = m_re.data();
+        float *im = m_im.data();
+        if constexpr (Half == 1) {
+            // Twiddle 1: no multiplies
+            for (size_t a = 0; a < HALF; a += 2) {
+                const float tr = re[a + 1], ti = im[a + 1];
+                re[a + 1] = re[a] - tr;
+                im[a + 1] = im[a] - ti;
+                re[a] += tr;
+                im[a] += ti;
+            }
+            return;
+        }
+        const float *stage_re = TABLES.stage_re.data() + Half - 1;
+        const float *stage_im = TABLES.stage_im.data() + Half - 1;
+        for (size_t block = 0; block < HALF; block += 2 * Half) {
+            for (size_t j = 0; j < Half; j++) {
+                const float wr = stage_re[j];
+                const float wi = stage_im[j];
+                const size_t a = block + j;
+                const size_t b = a + Half;
+                const float tr = re[b] * wr - im[b] * wi;
+                const float ti = re[b] * wi + im[b] * wr;
+                re[b] = re[a] - tr;
+                im[b] = im[a] - ti;
+                re[a] += tr;
+                im[a] += ti;
+            }
+        }
+    }
+
+    // Untangles the N / 2-point complex transform of the packed samples into the real spectrum
+    void split(const std::span<float> magnitudes) const {
+        for (size_t k = 0; k < BINS; k++) {
+            const size_t mirror = (HALF - k) & (HALF - 1);
+            const float zr = m_re[k], zi = m_im[k];
+            const float cr = m_re[mirror], ci = -m_im[mirror];
+            const float er = 0.5f * (zr + cr), ei = 0.5f * (zi + ci);
+            const float or_ = 0.5f * (zi - ci), oi = -0.5f * (zr - cr);
+            const float wr = TABLES.twiddle_re[k], wi = TABLES.twiddle_im[k];
+            const float xr = er + or_ * wr - oi * wi;
+            const float xi = ei + or_ * wi + oi * wr;
+            magnitudes[k] = std::sqrt(xr * xr + xi * xi);
+        }
+    }
+
+    static void apply_bands(const std::span<const float> magnitudes, const std::span<float> bars) {
+        for (size_t bar = 0; bar < Bars; bar++) {
+            const auto &band = BANDS.bands[bar];
+            float sum = 0.0f;
+            for (size_t i = 0; i < band.weight_count; i++) {
+                sum += BANDS.weights[band.weight_offset + i] * magnitudes[band.first_bin + i];
+            }
+            bars[bar] = sum;
+        }
+    }
+};
+
+// Picks a compiled-in SpectrumAnalyzer specialization for a runtime configuration
+class SpectrumAnalyzerRegistry {
+public:
+    struct Entry {
+        size_t fft_size;
+        size_t bar_count;
+        size_t sample_rate;
+        size_t low_frequency;
+        size_t high_frequency;
+        std::unique_ptr<StaticAnalyzer> (*create)();
+    };
+
+    // nullptr if no specialization matches; callers fall back to SpectrumEngine + BandMapper
+    static std::unique_ptr<StaticAnalyzer> create(size_t fft_size, size_t bar_count, size_t sample_rate,
+                                                  float low_frequency, float high_frequency);
+    static std::span<const Entry> entries();
+};
+
+#endif //SPECTRUMANALYZER_H
@@ -0,0 +1,72 @@
+//
+// Created by Sebastian Sandstig on 2026-10-17.
+//
+
+#ifndef SPECTRUMENGINE_H
+#define SPECTRUMENGINE_H
+
+#include <memory>
+#include <optional>
+#include <span>
+#include <string>
+#include <vector>
+
+// Real-input FFT producing magnitudes. One engine handles one transform size and owns whatever scratch it needs, so
+// a transform never allocates. Engines are not thread safe; give each thread its own.
+class SpectrumEngine {
+public:
+    enum Kind {
+        RADIX2 = 0,
+        RADIX4,
+        FFTW
+    };
+
+#ifdef SOUNDSCAPE_WITH_FFTW
+    static constexpr Kind DEFAULT_KIND = FFTW;
+#else
+    static constexpr Kind DEFAULT_KIND = RADIX4;
+#endif
+
+    explicit SpectrumEngine(const size_t size) : m_size(size) {}
+    virtual ~SpectrumEngine() = default;
+
+    [[nodiscard]] size_t size() const { return m_size; }
+    [[nodiscard]] size_t bin_count() const { return m_size / 2; }
+    [[nodiscard]] virtual Kind kind() const = 0;
+
+    // `older` followed by `newer` are the `size()` input samples in time order (the two halves of a ring
+    // snapshot). Samples are multiplied by `window` (`size()` coefficients, empty for none) as they are loaded.
+    // Writes `bin_count()` magnitudes.
+    virtual void transform(std::span<const float> older, std::span<const float> newer, std::span<const float> window,
+                           std::span<float> magnitudes) = 0;
+    void transform(const std::span<const float> older, const std::span<const float> newer,
+                   const std::span<float> magnitudes) {
+        transform(older, newer, {}, magnitudes);
+    }
+
+    // Throws if `kind` is not compiled in or `size` is not a power of two
+    static std::unique_ptr<SpectrumEngine> create(Kind kind, size_t size);
+    static const char* kind_name(Kind kind);
+    static std::optional<Kind> parse_kind(const std::string &name);
+private:
+    size_t m_size;
+};
+
+// The original hand-written complex radix-2 FFT, kept as the dependency free fallback and A/B baseline
+class Radix2SpectrumEngine final : public SpectrumEngine {
+public:
+    explicit Radix2SpectrumEngine(size_t size);
+
+    using SpectrumEngine::transform;
+    [[nodiscard]] Kind kind() const override { return RADIX2; }
+    void transform(std::span<const float> older, std::span<const float> newer, std::span<const float> window,
+                   std::span<float> magnitudes) override;
+private:
+    size_t m_log2_size;
+    std::vector<float> m_dft_real;
+    std::vector<float> m_dft_imag;
+
+    void load_bit_reversed(std::span<const float> samples, size_t offset, std::span<const float> window);
+};
+
+#endif //SPECTRUMENGINE_H
@@ -0,0 +1,72 @@
+//
+// Created by Sebastian Sandstig on 2026-10-17.
+//
+
+#ifndef STFT_H
+#define STFT_H
+
+#include <memory>
+#include <vector>
+
+#include <CaptureRing.h>
+#include <SpectrumEngine.h>
+
+// Sliding short-time Fourier transform over a CaptureRing.
+// Frames are `fft_size` samples long and end on a fixed grid of `hop_size` samples, so consecutive spectra overlap
+// by fft_size - hop_size samples. A spectrum is only computed once a whole new hop has arrived; if the caller falls
+// behind by several hops only the newest is computed and the rest are counted as skipped.
+// Magnitudes are scaled by 2 / sum(window), so a full-scale sine reads as ~1.0 whatever the window and size.
+class Stft {
+public:
+    enum Window {
+        RECTANGULAR = 0,
+        HANN,
+        BLACKMAN_HARRIS
+    };
+
+    Stft(const CaptureRing &ring, size_t fft_size, size_t hop_size, Window window = HANN,
+         SpectrumEngine::Kind engine = SpectrumEngine::DEFAULT_KIND);
+
+    [[nodiscard]] size_t fft_size() const { return m_engine->size(); }
+    [[nodiscard]] size_t hop_size() const { return m_hop_size; }
+    [[nodiscard]] size_t bin_count() const { return m_engine->bin_count(); }
+    [[nodiscard]] SpectrumEngine::Kind engine_kind() const { return m_engine->kind(); }
+    [[nodiscard]] Window window() const { return m_window_kind; }
+
+    // Frames covering each sample
+    [[nodiscard]] float overlap() const {
+        return static_cast<float>(fft_size()) / static_cast<float>(m_hop_size);
+    }
+    // Sum of the unscaled window over all frames covering a sample: what an overlap-add resynthesis divides by
+    [[nodiscard]] float overlap_add_gain() const { return m_window_sum / static_cast<float>(m_hop_size); }
+
+    // Ring cursor one past the newest sample of the current spectrum
+    [[nodiscard]] uint64_t frame_end() const { return m_frame_end; }
+    [[nodiscard]] uint64_t frame_count() const { return m_frame_count; }
+    [[nodiscard]] uint64_t skipped_hops() const { return m_skipped_hops; }
+    [[nodiscard]] const std::vector<float>& magnitudes() const { return m_magnitudes; }
+
+    // Computes the spectrum of the newest complete hop. Returns false, leaving the magnitudes untouched, if no new
+    // hop has arrived since the last call.
+    bool update();
+
+    // Unscaled coefficients
+    static std::vector<float> make_window(Window window, size_t size);
+    // Coefficients with the 2 / sum(window) magnitude normalisation folded in, as handed to the spectrum engines
+    static std::vector<float> make_scaled_window(Window window, size_t size);
+private:
+    const CaptureRing *m_ring;
+    size_t m_hop_size;
+    Window m_window_kind;
+    std::unique_ptr<SpectrumEngine> m_engine;
+    std::vector<float> m_window;        // Coefficients with the magnitude normalisation folded in
+    float m_window_sum = 0.0f;
+
+    uint64_t m_next_frame_end;
+    uint64_t m_frame_end = 0;
+    uint64_t m_frame_count = 0;
+    uint64_t m_skipped_hops = 0;
+    std::vector<float> m_magnitudes;
+};
+
+#endif //STFT_H
@@ -0,0 +1,72 @@
+//
+// Created by Sebastian Sandstig on 2026-10-17.
+//
+
+#ifndef SYNTHETICSOURCE_H
+#define SYNTHETICSOURCE_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include <BlockSource.h>
+
+// One component of a synthetic signal. Positions and lengths are in samples counted from the source's first sample,
+// so an event lands on exactly the sample asked for regardless of block size or pacing.
+struct SyntheticSignal {
+    enum Kind {
+        SINE = 0,
+        SWEEP,          // Exponential sweep from `frequency` to `end_frequency` over `length` samples
+        CLICK,          // Single-sample impulse, repeated every `period` samples if that is not 0
+        PINK_NOISE
+    };
+
+    Kind kind = SINE;
+    float amplitude = 0.5f;
+    float frequency = 1000.0f;
+    float end_frequency = 1000.0f;
+    uint64_t start = 0;             // First sample the component sounds on
+    uint64_t length = 0;            // Samples it lasts, 0 for ever (a sweep needs a length)
+    uint64_t period = 0;
+};
+
+// Generated test audio in place of a sound card: the sum of its components, written into the ring in `frame_size`
+// blocks like the PortAudio callback would. Output is fully deterministic, the pink noise included.
+class SyntheticSource final : public BlockSource {
+public:
+    // Stops by itself after `sample_limit` samples if that is not 0
+    SyntheticSource(size_t sample_rate, std::vector<SyntheticSignal> signals, double speed = 1.0,
+                    uint64_t sample_limit = 0);
+    ~SyntheticSource() override;
+
+    [[nodiscard]] const char* name() const override { return "synthetic"; }
+    [[nodiscard]] size_t sample_rate() const override { return m_sample_rate; }
+    [[nodiscard]] bool is_alive() const override { return true; }
+
+    // Produces the next `count` samples without writing them anywhere. Only while stopped: the source's thread
+    // uses the same state.
+    void generate(float *samples, size_t count);
+
+    // Components joined by '+', each one of
+    //   sine=HZ  sweep=HZ-HZ/SECONDS  click=SECONDS (the period, 0 for a single click)  pink
+    // optionally followed by *AMPLITUDE, e.g. "sine=440*0.3+click=0.5+pink*0.05". Throws std::runtime_error.
+    static std::vector<SyntheticSignal> parse(const std::string &spec, size_t sample_rate);
+protected:
+    size_t produce(float *samples, size_t count) override;
+private:
+    // Paul Kellett's pink filter over a xorshift white noise source
+    struct PinkState {
+        uint32_t seed;
+        float b[7] = {};
+    };
+
+    size_t m_sample_rate;
+    std::vector<SyntheticSignal> m_signals;
+    std::vector<PinkState> m_pink;
+    uint64_t m_sample_limit;
+    uint64_t m_generated = 0;
+
+    [[nodiscard]] float sample(size_t component, uint64_t position);
+};
+
+#endif //SYNTHETICSOURCE_H
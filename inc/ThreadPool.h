@@ -0,0 +1,50 @@
+//
+// Created by Sebastian Sandstig on 2026-10-17.
+//
+
+#ifndef THREADPOOL_H
+#define THREADPOOL_H
+
+#include <condition_variable>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Fixed set of worker threads for batch jobs (offline analysis), not for anything on the live audio path.
+class ThreadPool {
+public:
+    // 0 uses every hardware thread
+    explicit ThreadPool(size_t thread_count = 0);
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    [[nodiscard]] size_t thread_count() const { return m_workers.size(); }
+
+    // Runs task(index, worker) for every index in [0, count) across the workers and returns once all are done.
+    // `worker` is in [0, thread_count()), so tasks can use per-worker scratch state without locking. The first
+    // exception thrown by a task is rethrown here after the remaining tasks have finished.
+    void parallel_for(size_t count, const std::function<void(size_t index, size_t worker)> &task);
+private:
+    std::vector<std::thread> m_workers;
+    std::mutex m_mutex;
+    std::condition_variable m_work_ready;
+    std::condition_variable m_work_done;
+
+    // The current batch, guarded by m_mutex
+    const std::function<void(size_t, size_t)> *m_task = nullptr;
+    size_t m_count = 0;
+    size_t m_next = 0;
+    size_t m_running = 0;
+    uint64_t m_generation = 0;
+    std::exception_ptr m_error;
+    bool m_stop = false;
+
+    void work(size_t worker);
+};
+
+#endif //THREADPOOL_H
@@ -0,0 +1,89 @@
+//
+// Created by Sebastian Sandstig on 2026-10-17.
+//
+
+#ifndef THREADTUNING_H
+#define THREADTUNING_H
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <span>
+#include <string>
+#include <vector>
+
+// How one of our threads should be scheduled
+struct ThreadPolicy {
+    int realtime_priority = 0;      // SCHED_FIFO priority from 1 to 99, 0 to stay in the default time-sharing class
+    std::vector<int> cpus;          // CPUs the thread may run on, empty for any
+
+    [[nodiscard]] bool is_default() const { return realtime_priority == 0 && cpus.empty(); }
+    // "3", "2,3" or "0-3,6"; throws std::runtime_error
+    static std::vector<int> parse_cpus(const std::string &list);
+};
+
+struct ThreadTuningSettings {
+    ThreadPolicy audio;             // The source's thread: the PortAudio callback, or the file/pipe/synthetic writer
+    ThreadPolicy dsp;               // The analysis thread
+    ThreadPolicy recognition;
+    ThreadPolicy render;
+    bool lock_memory = false;       // mlock the capture ring and the analysis buffers
+};
+
+// Puts threads on the CPUs and in the scheduling class they were configured for, on Linux, and keeps a report of
+// what each one actually got: a real-time priority is only granted with CAP_SYS_NICE or an rtprio limit (see
+// limits.conf), and a refusal is reported rather than fatal. Elsewhere policies are reported as unsupported.
+class ThreadTuning {
+public:
+    // What applying a policy got, gathered with system calls alone
+    struct Outcome {
+        int affinity_error = 0;                     // errno-style, 0 if granted or not asked for
+        int priority_error = 0;
+        int scheduler = 0;                          // As the kernel reports it afterwards
+        int priority = 0;
+        bool cpus_known = false;
+        std::array<uint64_t, 16> cpus {};           // Bit per CPU the thread may run on, up to 1024
+    };
+
+    // For a thread we do not create and only get to run code on in a real-time context, the PortAudio callback.
+    // Constructed off that thread; `apply` on it makes only the system calls, no allocation and no lock, and the
+    // outcome joins the report the next time it is printed (or when this is destroyed).
+    class Deferred {
+    public:
+        Deferred(const char *role, ThreadPolicy policy);
+        ~Deferred();
+
+        Deferred(const Deferred&) = delete;
+        Deferred& operator=(const Deferred&) = delete;
+
+        // Only the first call does anything, and nothing at all for a default policy
+        void apply();
+    private:
+        friend class ThreadTuning;
+
+        const char *m_role;
+        ThreadPolicy m_policy;
+        bool m_applied = false;                     // Only touched by the tuned thread
+        Outcome m_outcome;                          // Written before m_ready is set, read after
+        std::atomic<bool> m_ready = false;
+        bool m_reported = false;                    // Under the report lock
+    };
+
+    // Applies `policy` to the calling thread. Threads inherit both settings from the thread that creates them, so
+    // a thread that starts others should apply its own policy after it has done so.
+    static void apply(const char *role, const ThreadPolicy &policy);
+    // Locks `memory` into RAM so the real-time path never takes a page fault on it. False if the kernel refused.
+    static bool lock_memory(const char *what, std::span<const std::byte> memory);
+
+    // One line per thread tuned and per memory lock, in the order they happened
+    static void print_report(std::ostream &out);
+private:
+    static Outcome tune(const ThreadPolicy &policy);
+    static std::string describe(const ThreadPolicy &policy, const Outcome &outcome);
+    // Folds a deferred outcome that is ready into the report; called with the report lock held
+    static void collect(Deferred &deferred);
+};
+
+#endif //THREADTUNING_H
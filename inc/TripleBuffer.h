@@ -0,0 +1,54 @@
+//
+// Created by Sebastian Sandstig on 2026-10-17.
+//
+
+#ifndef TRIPLEBUFFER_H
+#define TRIPLEBUFFER_H
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+
+// Lock-free handoff of the latest value from one producer thread to one consumer thread.
+// The producer fills `back()` and `publish()`es it, the consumer calls `update()` and reads `front()`. Neither side
+// ever waits for the other: the third slot sits in between, always holding the newest published value, and is
+// swapped in with a single atomic exchange. Values the consumer never got round to are simply dropped.
+template<typename T>
+class TripleBuffer {
+public:
+    TripleBuffer() = default;
+    // Every slot starts as a copy of `initial`, so slots can be pre-sized and neither side allocates later on
+    explicit TripleBuffer(const T &initial) : m_slots{Slot{initial}, Slot{initial}, Slot{initial}} {}
+
+    TripleBuffer(const TripleBuffer&) = delete;
+    TripleBuffer& operator=(const TripleBuffer&) = delete;
+
+    // Producer side. The slot holds whatever was published some time ago, overwrite all of it.
+    T& back() { return m_slots[m_back].value; }
+    void publish() {
+        m_back = m_middle.exchange(m_back | FRESH, std::memory_order_acq_rel) & INDEX;
+    }
+
+    // Consumer side. Takes the newest published value if there is one; returns false if `front()` is still current.
+    bool update() {
+        if ((m_middle.load(std::memory_order_relaxed) & FRESH) == 0) return false;
+        m_front = m_middle.exchange(m_front, std::memory_order_acq_rel) & INDEX;
+        return true;
+    }
+    [[nodiscard]] const T& front() const { return m_slots[m_front].value; }
+
+private:
+    struct alignas(64) Slot {
+        T value;
+    };
+
+    static constexpr uint8_t INDEX = 0x3;
+    static constexpr uint8_t FRESH = 0x4;
+
+    std::array<Slot, 3> m_slots{};
+    alignas(64) uint8_t m_back = 0;                     // Producer only
+    alignas(64) std::atomic<uint8_t> m_middle = 1;      // Slot index, FRESH once published and not yet consumed
+    alignas(64) uint8_t m_front = 2;                    // Consumer only
+};
+
+#endif //TRIPLEBUFFER_H
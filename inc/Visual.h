@@ -5,6 +5,7 @@
 #ifndef VISUAL_H
 #define VISUAL_H
 
+#include <chrono>
 #include <iostream>
 #include <map>
 
@@ -36,6 +37,14 @@ public:
     virtual ~InterFrame() = default;
 
     virtual void inter_frame() {}
+    // Steady clock times of the frame drawn right after the last `inter_frame`: when its commands were submitted
+    // and when vkQueuePresentKHR returned for it
+    virtual void frame_presented(std::chrono::steady_clock::time_point submitted,
+                                 std::chrono::steady_clock::time_point presented) {}
+    // The GPU finished the frame submitted at `submitted`. Noticed when its fence is next waited on, so `completed`
+    // is exact if that wait blocked and an upper bound if the fence had already signalled.
+    virtual void frame_completed(std::chrono::steady_clock::time_point submitted,
+                                 std::chrono::steady_clock::time_point completed) {}
 };
 
 class Visual {
@@ -82,6 +91,7 @@ private:
     bool m_window_resized = false;
     bool m_framebuffer_resized = false;
     size_t m_current_frame = 0;
+    InterFrame* m_inter_frame = nullptr;
 
     VkInstance m_instance = VK_NULL_HANDLE;
     VkDebugUtilsMessengerEXT m_debug_messenger = VK_NULL_HANDLE;
@@ -95,6 +105,7 @@ private:
     std::vector<VkSemaphore> m_image_available_semaphores;
     std::vector<VkSemaphore> m_render_finished_semaphores;
     std::vector<VkFence> m_in_flight_fences;
+    std::vector<std::chrono::steady_clock::time_point> m_submit_times;     // Per frame in flight, unset once reported
 
     std::map<const char*, Sprite*> m_sprites;
     std::shared_ptr<TextureManager> m_texture_manager;
@@ -0,0 +1,32 @@
+//
+// Created by Sebastian Sandstig on 2026-10-17.
+//
+
+#ifndef WAVREADER_H
+#define WAVREADER_H
+
+#include <string>
+#include <vector>
+
+// Decodes a RIFF/WAVE file into mono float samples in [-1, 1].
+// Handles integer PCM of 8, 16, 24 and 32 bits, 32/64-bit IEEE float, and WAVE_FORMAT_EXTENSIBLE wrapping either.
+// Multichannel files are mixed down by averaging the channels. Throws std::runtime_error on anything else.
+class WavReader {
+public:
+    explicit WavReader(const std::string &path);
+
+    [[nodiscard]] size_t sample_rate() const { return m_sample_rate; }
+    [[nodiscard]] size_t channel_count() const { return m_channel_count; }
+    [[nodiscard]] size_t bits_per_sample() const { return m_bits_per_sample; }
+    [[nodiscard]] double duration() const {
+        return static_cast<double>(m_samples.size()) / static_cast<double>(m_sample_rate);
+    }
+    [[nodiscard]] const std::vector<float>& samples() const { return m_samples; }
+private:
+    size_t m_sample_rate = 0;
+    size_t m_channel_count = 0;
+    size_t m_bits_per_sample = 0;
+    std::vector<float> m_samples;
+};
+
+#endif //WAVREADER_H
@@ -0,0 +1,77 @@
+//
+// Created by Sebastian Sandstig on 2026-10-17.
+//
+
+#ifndef HTTP_CLIENT_H
+#define HTTP_CLIENT_H
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include <curl/curl.h>
+
+namespace Communication {
+
+// The process's one set of libcurl handles, shared by song recognition and cover art downloads so that consecutive
+// requests skip the DNS lookup and the TCP and TLS handshakes. Easy handles are pooled rather than created per request:
+// each keeps its idle connections open between the requests it serves, and the pool hands out the most recently
+// returned one, whose connections are the warmest. DNS results and TLS sessions are shared by all handles through a
+// CURLSH, so even a handle's first connection to a host resumes the TLS session another one negotiated.
+// Thread-safe; a handle serves one request at a time.
+class HttpClient {
+public:
+    struct Request {
+        std::string url;
+        const std::string *post_fields = nullptr;   // POSTed as JSON if set, otherwise a GET
+        const char *user_agent = nullptr;
+        bool decode = false;                        // Have curl decompress a gzip, deflate or br body
+        const std::atomic<bool> *cancel = nullptr;  // Aborts the transfer once true
+    };
+    struct Response {
+        std::string body;                           // Empty if aborted
+        int64_t status = 0;                         // HTTP status, 0 without a response
+        bool aborted = false;                       // Through `cancel`
+        std::string error;                          // Why the transfer failed, empty if it did not
+    };
+    struct Counters {
+        uint64_t requests = 0;
+        uint64_t connections = 0;                   // New connections opened; requests minus these rode warm ones
+    };
+
+    static HttpClient& shared();
+
+    HttpClient(const HttpClient&) = delete;
+    HttpClient& operator=(const HttpClient&) = delete;
+
+    Response perform(const Request &request);
+
+    [[nodiscard]] Counters counters() const;
+    void print(std::ostream &out) const;
+private:
+    HttpClient();
+    ~HttpClient() = default;
+
+    CURLSH *m_share;
+    curl_slist *m_headers;                          // Built once, read-only after
+    std::array<std::mutex, CURL_LOCK_DATA_LAST> m_share_locks;
+
+    std::mutex m_pool_mutex;
+    std::vector<CURL *> m_idle;                     // Most recently returned last
+
+    std::atomic<uint64_t> m_requests = 0;
+    std::atomic<uint64_t> m_connections = 0;
+
+    CURL *acquire();
+    void release(CURL *handle);
+    static void lock_share(CURL *handle, curl_lock_data data, curl_lock_access access, void *client);
+    static void unlock_share(CURL *handle, curl_lock_data data, void *client);
+};
+
+}
+
+#endif //HTTP_CLIENT_H
@@ -1,6 +1,7 @@
 #ifndef CLI_COMMUNICATION_SHAZAM_H_
 #define CLI_COMMUNICATION_SHAZAM_H_
 
+#include <atomic>
 #include <string>
 
 // forward declaration
@@ -12,7 +13,8 @@ class Shazam
     static constexpr char HOST[] = "https://amp.shazam.com/discovery/v5/fr/FR/android/-/tag/";
 
 public:
-    static std::string Recognize(const Fingerprint *fingerprint);
+    // Aborts the request, returning an empty string, once `cancel` becomes true
+    static std::string Recognize(const Fingerprint *fingerprint, const std::atomic<bool> *cancel = nullptr);
 
 private:
     static std::string getShazamHost();
@@ -0,0 +1,139 @@
+//
+// Created by Sebastian Sandstig on 2026-10-17.
+//
+
+#include <AnalysisThread.h>
+
+#include <algorithm>
+#include <stdexcept>
+
+namespace {
+    std::vector<SpectrumResolution> resolutions(const AnalysisSettings &settings) {
+        std::vector<SpectrumResolution> all = settings.detail_resolutions;
+        all.push_back(SpectrumResolution {settings.fft_size, settings.hop_size, 0.0f});
+        return all;
+    }
+
+    size_t largest_fft(const AnalysisSettings &settings) {
+        size_t largest = settings.fft_size;
+        for (const auto &resolution : settings.detail_resolutions) {
+            largest = std::max(largest, resolution.fft_size);
+        }
+        return largest;
+    }
+}
+
+AnalysisThread::AnalysisThread(const std::shared_ptr<CaptureRing> &capture, const size_t capture_rate,
+                               const AnalysisSettings &settings) : m_capture(capture),
+    m_analysis_rate(settings.analysis_rate), m_thread_policy(settings.thread_policy), m_reader(*capture), m_resampler(capture_rate, settings.analysis_rate),
+    m_capture_block(settings.block_size), m_resampled_block(m_resampler.max_output(settings.block_size)),
+    m_analysis_ring(2 * largest_fft(settings)),
+    m_analyzer(m_analysis_ring, settings.analysis_rate, resolutions(settings), settings.band_count,
+               settings.band_low_frequency, settings.band_high_frequency, settings.band_scale, settings.window,
+               settings.spectrum_engine),
+    m_beats(settings.band_count, static_cast<float>(settings.analysis_rate) / static_cast<float>(settings.hop_size)),
+    m_music(m_analyzer.primary().bin_count(),
+            static_cast<float>(settings.analysis_rate) / static_cast<float>(settings.fft_size),
+            static_cast<float>(settings.analysis_rate) / static_cast<float>(settings.hop_size)),
+    m_requested_band_count(settings.band_count),
+    m_frames(AnalysisFrame {
+        .magnitudes = std::vector<float>(m_analyzer.primary().bin_count()),
+        .band_energies = std::vector<float>(settings.band_count),
+    }),
+    m_continue(false) {}
+
+AnalysisThread::~AnalysisThread() {
+    stop();
+}
+
+void AnalysisThread::start() {
+    if (m_thread.joinable()) return;
+    // Start from live audio rather than whatever piled up while stopped
+    m_reader.skip_to_latest();
+    m_continue.store(true, std::memory_order_relaxed);
+    m_thread = std::thread(&AnalysisThread::run, this);
+}
+
+void AnalysisThread::stop() {
+    if (!m_thread.joinable()) return;
+    // Released before interrupt() bumps the epoch, so a run() that sees the new epoch also sees the stop
+    m_continue.store(false, std::memory_order_release);
+    m_capture->interrupt();
+    m_thread.join();
+}
+
+const AnalysisFrame& AnalysisThread::latest() {
+    m_frames.update();
+    return m_frames.front();
+}
+
+void AnalysisThread::set_band_count(const size_t band_count) {
+    if (band_count == 0) {
+        throw std::runtime_error("AnalysisThread: band_count must be at least 1");
+    }
+    m_requested_band_count.store(band_count, std::memory_order_relaxed);
+}
+
+bool AnalysisThread::lock_memory() const {
+    const bool ring = ThreadTuning::lock_memory("analysis ring", m_analysis_ring.memory());
+    const bool capture = ThreadTuning::lock_memory("capture block", std::as_bytes(std::span(m_capture_block)));
+    const bool resampled = ThreadTuning::lock_memory("resampled block", std::as_bytes(std::span(m_resampled_block)));
+    return ring && capture && resampled;
+}
+
+void AnalysisThread::run() {
+    ThreadTuning::apply("dsp", m_thread_policy);
+    while (m_continue.load(std::memory_order_acquire)) {
+        const uint32_t epoch = m_capture->epoch();
+        pump();
+        // The stamp of the samples actually consumed, and picked up only once they have been
+        m_capture_time = m_reader.captured();
+        m_pickup_time = std::chrono::steady_clock::now();
+        // Rebuilding the band tables is a few microseconds and only happens when the bar count actually changes
+        const size_t band_count = m_requested_band_count.load(std::memory_order_relaxed);
+        m_analyzer.set_band_count(band_count);
+        m_beats.set_band_count(band_count);
+        // Publishing only the newest hop is enough for a display; Stft counts the ones passed over
+        const uint64_t primary_frames = m_analyzer.primary().frame_count();
+        if (m_analyzer.update()) {
+            if (m_analyzer.primary().frame_count() != primary_frames) {
+                m_beats.process(m_analyzer.band_energies());
+                if (m_music.process(m_analyzer.primary().magnitudes())) {
+                    m_music_changes.store(m_music.state().change_count, std::memory_order_release);
+                    if (m_on_music_change) m_on_music_change();
+                }
+                m_silent.store(m_music.state().silent, std::memory_order_relaxed);
+            }
+            publish();
+        }
+        // A stop between the loop's check and the epoch read already spent its interrupt; with the source stopped
+        // no write would ever end this wait
+        if (!m_continue.load(std::memory_order_acquire)) break;
+        m_capture->wait(epoch);
+    }
+}
+
+void AnalysisThread::pump() {
+    size_t count;
+    while ((count = m_reader.read(m_capture_block.data(), m_capture_block.size())) > 0) {
+        const auto produced = m_resampler.process(m_capture_block.data(), count, m_resampled_block.data());
+        m_analysis_ring.write(m_resampled_block.data(), produced);
+    }
+    m_lost_samples.store(m_reader.lost(), std::memory_order_relaxed);
+}
+
+void AnalysisThread::publish() {
+    auto &frame = m_frames.back();
+    std::ranges::copy(m_analyzer.primary().magnitudes(), frame.magnitudes.begin());
+    frame.band_energies.assign(m_analyzer.band_energies().begin(), m_analyzer.band_energies().end());
+
+    frame.beat = m_beats.state();
+    frame.music = m_music.state();
+    frame.sample_position = m_analyzer.frame_end();
+    frame.time = static_cast<double>(frame.sample_position) / static_cast<double>(m_analysis_rate);
+    frame.sequence = ++m_published;
+    frame.capture_time = m_capture_time;
+    frame.pickup_time = m_pickup_time;
+    frame.publish_time = std::chrono::steady_clock::now();
+    m_frames.publish();
+}
@@ -0,0 +1,42 @@
+//
+// Created by Sebastian Sandstig on 2026-10-17.
+//
+
+#include <AudioSource.h>
+
+#include <stdexcept>
+
+#include <FileSource.h>
+#include <PipeSource.h>
+#include <PortAudioSource.h>
+#include <SyntheticSource.h>
+
+namespace {
+    constexpr size_t DEFAULT_SAMPLE_RATE = 48000;
+    // A tone to find in the bars and a click twice a second to find the beat
+    constexpr auto DEFAULT_SYNTHETIC = "sine=1000*0.3+click=0.5*0.8";
+}
+
+std::unique_ptr<AudioSource> AudioSource::create(const AudioSourceSettings &settings) {
+    const std::string &source = settings.source;
+    const size_t rate = settings.sample_rate != 0 ? settings.sample_rate : DEFAULT_SAMPLE_RATE;
+    const auto argument = [&source](const size_t prefix) { return source.substr(prefix); };
+
+    if (source == "portaudio") {
+        return std::make_unique<PortAudioSource>(settings.sample_rate);
+    }
+    if (source == "synthetic" || source.starts_with("synthetic:")) {
+        const std::string spec = source == "synthetic" ? DEFAULT_SYNTHETIC : argument(10);
+        return std::make_unique<SyntheticSource>(rate, SyntheticSource::parse(spec, rate), settings.speed);
+    }
+    if (source.starts_with("file:")) {
+        return std::make_unique<FileSource>(argument(5), settings.speed, settings.loop, settings.pcm_format, rate);
+    }
+    if (source.starts_with("pipe:")) {
+        return std::make_unique<PipeSource>(argument(5), rate, settings.pcm_format);
+    }
+    if (source == "-") {
+        return std::make_unique<PipeSource>("-", rate, settings.pcm_format);
+    }
+    throw std::runtime_error("AudioSource: unknown source '" + source + "'");
+}
\ No newline at end of file
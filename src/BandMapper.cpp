@@ -0,0 +1,162 @@
+//
+// Created by Sebastian Sandstig on 2026-10-17.
+//
+
+#include <BandMapper.h>
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+namespace {
+    float to_mel(const float frequency) { return 2595.0f * std::log10(1.0f + frequency / 700.0f); }
+    float from_mel(const float mel) { return 700.0f * (std::pow(10.0f, mel / 2595.0f) - 1.0f); }
+
+    // Rises from 0 at `lower` to 1 at `center` and falls back to 0 at `upper`
+    float triangle(const float x, const float lower, const float center, const float upper) {
+        if (x <= lower || x >= upper) return 0.0f;
+        return x < center ? (x - lower) / (center - lower) : (upper - x) / (upper - center);
+    }
+}
+
+BandMapper::BandMapper(const size_t fft_size, const size_t sample_rate, const size_t band_count,
+                       const float low_frequency, const float high_frequency, const Scale scale) :
+    m_fft_size(fft_size), m_sample_rate(sample_rate), m_low_frequency(low_frequency),
+    m_high_frequency(std::min(high_frequency, static_cast<float>(sample_rate) / 2.0f)), m_scale(scale)
+{
+    if (fft_size < 4) {
+        throw std::runtime_error("BandMapper: fft_size too small");
+    }
+    if (low_frequency <= 0.0f || m_high_frequency <= low_frequency) {
+        throw std::runtime_error("BandMapper: need 0 < low_frequency < high_frequency <= sample_rate / 2");
+    }
+    build(band_count);
+}
+
+void BandMapper::set_band_count(const size_t band_count) {
+    if (band_count == m_bands.size()) return;
+    build(band_count);
+}
+
+void BandMapper::apply(const std::span<const float> magnitudes, const std::span<float> bands) const {
+    apply(magnitudes, bands, 0, m_bands.size());
+}
+
+void BandMapper::apply(const std::span<const float> magnitudes, const std::span<float> bands, const size_t first_band,
+                       const size_t last_band) const {
+    for (size_t band = first_band; band < last_band; band++) {
+        const auto &b = m_bands[band];
+        const float *weights = m_weights.data() + b.weight_offset;
+        const float *bins = magnitudes.data() + b.first_bin;
+
+        // Eight independent lanes: the compiler keeps them in vector registers without having to reorder the sum
+        float lanes[8] = {};
+        size_t i = 0;
+        for (; i + 8 <= b.weight_count; i += 8) {
+            for (size_t lane = 0; lane < 8; lane++) {
+                lanes[lane] += weights[i + lane] * bins[i + lane];
+            }
+        }
+        float sum = 0.0f;
+        for (; i < b.weight_count; i++) {
+            sum += weights[i] * bins[i];
+        }
+        for (const float lane : lanes) {
+            sum += lane;
+        }
+        bands[band] = sum;
+    }
+}
+
+const char* BandMapper::scale_name(const Scale scale) {
+    switch (scale) {
+        case LOG:
+            return "log";
+        case MEL:
+            return "mel";
+        case CONSTANT_Q:
+            return "cq";
+    }
+    return "unknown";
+}
+
+std::optional<BandMapper::Scale> BandMapper::parse_scale(const std::string &name) {
+    for (const auto scale : {LOG, MEL, CONSTANT_Q}) {
+        if (name == scale_name(scale)) return scale;
+    }
+    return std::nullopt;
+}
+
+void BandMapper::build(const size_t band_count) {
+    if (band_count == 0) {
+        throw std::runtime_error("BandMapper: band_count must be at least 1");
+    }
+
+    const bool mel = m_scale == MEL;
+    const float low = mel ? to_mel(m_low_frequency) : std::log2(m_low_frequency);
+    const float high = mel ? to_mel(m_high_frequency) : std::log2(m_high_frequency);
+    const float step = (high - low) / static_cast<float>(band_count + 1);
+    // Centre k + 1 sits between edge points k and k + 2 in the scale's own units
+    const auto point = [&](const size_t k) { return low + step * static_cast<float>(k); };
+    const auto to_hz = [&](const float value) { return mel ? from_mel(value) : std::exp2(value); };
+
+    // Constant-Q: a band's half-width is centre / Q, with Q set by how many bands share an octave
+    const float bands_per_octave = static_cast<float>(band_count) / std::log2(m_high_frequency / m_low_frequency);
+    const float inverse_q = std::exp2(1.0f / bands_per_octave) - 1.0f;
+
+    const size_t bin_count = m_fft_size / 2;
+    const float bin_width = static_cast<float>(m_sample_rate) / static_cast<float>(m_fft_size);
+
+    m_bands.clear();
+    m_weights.clear();
+    std::vector<float> run;
+    for (size_t band = 0; band < band_count; band++) {
+        const float center = to_hz(point(band + 1));
+        float lower = to_hz(point(band));
+        float upper = to_hz(point(band + 2));
+        if (m_scale == CONSTANT_Q) {
+            lower = center * (1.0f - inverse_q);
+            upper = center * (1.0f + inverse_q);
+        }
+
+        const auto weight = [&](const size_t bin) {
+            const float frequency = static_cast<float>(bin) * bin_width;
+            if (m_scale == LOG) {
+                return bin == 0 ? 0.0f : triangle(std::log2(frequency), point(band), point(band + 1), point(band + 2));
+            }
+            return triangle(frequency, lower, center, upper);
+        };
+
+        const size_t first = std::min(static_cast<size_t>(std::ceil(lower / bin_width)), bin_count - 1);
+        const size_t last = std::min(static_cast<size_t>(std::floor(upper / bin_width)), bin_count - 1);
+        run.clear();
+        size_t run_first = first;
+        for (size_t bin = first; bin <= last; bin++) {
+            const float w = weight(bin);
+            if (w <= 0.0f && run.empty()) {
+                run_first = bin + 1;
+                continue;
+            }
+            run.push_back(w);
+        }
+        while (!run.empty() && run.back() <= 0.0f) run.pop_back();
+
+        if (run.empty()) {
+            // Narrower than a bin (low bands of a short FFT): fall back to the bin nearest the centre
+            run_first = std::min(static_cast<size_t>(std::lround(center / bin_width)), bin_count - 1);
+            run.push_back(1.0f);
+        }
+
+        float sum = 0.0f;
+        for (const float w : run) sum += w;
+        m_bands.push_back(Band {
+            .first_bin = run_first,
+            .weight_offset = m_weights.size(),
+            .weight_count = run.size(),
+            .lower = lower,
+            .center = center,
+            .upper = upper,
+        });
+        for (const float w : run) m_weights.push_back(w / sum);
+    }
+}
@@ -0,0 +1,160 @@
+//
+// Created by Sebastian Sandstig on 2026-10-17.
+//
+
+#include <BeatTracker.h>
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+namespace {
+    // log(1 + C x): with magnitudes normalised to ~1 at full scale, -60 dB lands near log(2)
+    constexpr float COMPRESSION = 1000.0f;
+    constexpr float THRESHOLD_SECONDS = 0.5f;       // Window of the running mean / deviation
+    constexpr float THRESHOLD_DEVIATIONS = 1.5f;
+    constexpr float THRESHOLD_FLOOR = 0.02f;        // Keeps near-silence from producing onsets
+    constexpr float MIN_ONSET_GAP_SECONDS = 0.1f;
+    constexpr float ENVELOPE_MEAN_SECONDS = 1.0f;
+    constexpr float CORRELATION_SECONDS = 8.0f;     // Memory of the tempo estimate
+    constexpr float MIN_TEMPO = 60.0f;
+    constexpr float MAX_TEMPO = 200.0f;
+    constexpr float PREFERRED_TEMPO = 120.0f;
+    constexpr float PHASE_GAIN = 0.2f;              // How far one onset pulls the beat phase towards itself
+}
+
+BeatTracker::BeatTracker(const size_t band_count, const float frame_rate) : m_frame_rate(frame_rate) {
+    if (frame_rate <= 0.0f) {
+        throw std::runtime_error("BeatTracker: frame_rate must be positive");
+    }
+    m_min_lag = std::max<size_t>(static_cast<size_t>(std::floor(frame_rate * 60.0f / MAX_TEMPO)), 2);
+    m_max_lag = std::max(static_cast<size_t>(std::ceil(frame_rate * 60.0f / MIN_TEMPO)), m_min_lag);
+    m_correlation_decay = std::exp(-1.0f / (frame_rate * CORRELATION_SECONDS));
+    m_envelope_decay = std::exp(-1.0f / (frame_rate * ENVELOPE_MEAN_SECONDS));
+
+    m_flux_history.resize(std::max<size_t>(static_cast<size_t>(frame_rate * THRESHOLD_SECONDS), 1));
+    // One extra lag on each side for the peak interpolation
+    m_envelope.resize(m_max_lag + 2);
+    m_correlation.resize(m_max_lag + 2);
+    m_tempo_prior.resize(m_max_lag + 2);
+    for (size_t lag = 1; lag < m_tempo_prior.size(); lag++) {
+        const float octaves = std::log2(frame_rate * 60.0f / static_cast<float>(lag) / PREFERRED_TEMPO);
+        m_tempo_prior[lag] = std::exp(-0.5f * octaves * octaves);
+    }
+
+    set_band_count(band_count);
+}
+
+void BeatTracker::set_band_count(const size_t band_count) {
+    if (band_count == 0) {
+        throw std::runtime_error("BeatTracker: band_count must be at least 1");
+    }
+    if (band_count == m_previous.size()) return;
+    m_previous.assign(band_count, 0.0f);
+    m_primed = false;
+}
+
+void BeatTracker::process(const std::span<const float> band_energies) {
+    const size_t bands = std::min(band_energies.size(), m_previous.size());
+    float flux = 0.0f;
+    for (size_t band = 0; band < bands; band++) {
+        const float compressed = std::log1p(COMPRESSION * band_energies[band]);
+        flux += std::max(compressed - m_previous[band], 0.0f);
+        m_previous[band] = compressed;
+    }
+    flux = m_primed ? flux / static_cast<float>(bands) : 0.0f;
+    m_primed = true;
+
+    const float window = static_cast<float>(m_flux_history.size());
+    const float mean = m_flux_sum / window;
+    const float deviation = std::sqrt(std::max(m_flux_square_sum / window - mean * mean, 0.0f));
+    const float threshold = mean + THRESHOLD_DEVIATIONS * deviation + THRESHOLD_FLOOR;
+    const uint64_t onsets = m_state.onset_count;
+    pick_onset(flux, threshold);
+
+    // Running sums over the threshold window, recomputed now and then so float drift cannot build up
+    const float oldest = m_flux_history[m_flux_position];
+    m_flux_history[m_flux_position] = flux;
+    m_flux_position = (m_flux_position + 1) % m_flux_history.size();
+    m_flux_sum += flux - oldest;
+    m_flux_square_sum += flux * flux - oldest * oldest;
+    if (m_flux_position == 0) {
+        m_flux_sum = m_flux_square_sum = 0.0f;
+        for (const float value : m_flux_history) {
+            m_flux_sum += value;
+            m_flux_square_sum += value * value;
+        }
+    }
+
+    m_envelope_mean = m_envelope_decay * m_envelope_mean + (1.0f - m_envelope_decay) * flux;
+    estimate_tempo(std::max(flux - m_envelope_mean, 0.0f));
+    advance_phase(m_state.onset_count != onsets);
+
+    m_state.onset_strength = flux;
+    m_state.threshold = threshold;
+}
+
+void BeatTracker::pick_onset(const float flux, const float threshold) {
+    // The previous hop is an onset if it is a local maximum above the threshold
+    const bool peak = m_previous_flux > m_previous_previous_flux && m_previous_flux >= flux &&
+                      m_previous_flux > threshold;
+    const auto min_gap = static_cast<size_t>(MIN_ONSET_GAP_SECONDS * m_frame_rate);
+    if (peak && m_hops_since_onset >= min_gap) {
+        m_state.onset_count++;
+        m_hops_since_onset = 0;
+    } else {
+        m_hops_since_onset++;
+    }
+    m_previous_previous_flux = m_previous_flux;
+    m_previous_flux = flux;
+}
+
+void BeatTracker::estimate_tempo(const float envelope) {
+    const size_t size = m_envelope.size();
+    m_envelope[m_envelope_position] = envelope;
+    for (size_t lag = m_min_lag - 1; lag <= m_max_lag + 1 && lag < size; lag++) {
+        const float delayed = m_envelope[(m_envelope_position + size - lag) % size];
+        m_correlation[lag] = m_correlation_decay * m_correlation[lag] + envelope * delayed;
+    }
+    m_envelope_position = (m_envelope_position + 1) % size;
+    m_hop_count++;
+    if (m_hop_count < 2 * size) return;
+
+    size_t best = 0;
+    float best_score = 0.0f;
+    for (size_t lag = m_min_lag; lag <= m_max_lag; lag++) {
+        const float score = m_correlation[lag] * m_tempo_prior[lag];
+        if (score > best_score) {
+            best_score = score;
+            best = lag;
+        }
+    }
+    if (best == 0) return;
+
+    // Parabola through the peak and its neighbours for a fractional period
+    const float before = m_correlation[best - 1] * m_tempo_prior[best - 1];
+    const float after = best + 1 < size ? m_correlation[best + 1] * m_tempo_prior[best + 1] : before;
+    const float curvature = before - 2.0f * best_score + after;
+    const float offset = curvature < 0.0f ? std::clamp(0.5f * (before - after) / curvature, -0.5f, 0.5f) : 0.0f;
+    m_period = static_cast<float>(best) + offset;
+    m_state.tempo = 60.0f * m_frame_rate / m_period;
+}
+
+void BeatTracker::advance_phase(const bool onset) {
+    if (m_period <= 0.0f) return;
+    const float step = 1.0f / m_period;
+
+    if (onset) {
+        // The onset peaked one hop ago; pull the phase so that hop would have been on the beat
+        const float onset_phase = m_state.beat_phase - step;
+        const float error = onset_phase - std::round(onset_phase);
+        m_state.beat_phase -= PHASE_GAIN * error;
+    }
+
+    m_state.beat_phase += step;
+    while (m_state.beat_phase >= 1.0f) {
+        m_state.beat_phase -= 1.0f;
+        m_state.beat_count++;
+    }
+    if (m_state.beat_phase < 0.0f) m_state.beat_phase += 1.0f;
+}
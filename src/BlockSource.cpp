@@ -0,0 +1,89 @@
+//
+// Created by Sebastian Sandstig on 2026-10-17.
+//
+
+#include <BlockSource.h>
+
+#include <chrono>
+#include <stdexcept>
+#include <vector>
+
+#include <ThreadTuning.h>
+
+BlockSource::BlockSource(const double speed) : m_speed(speed) {
+    if (m_speed < 0.0) {
+        throw std::runtime_error("BlockSource: speed must not be negative");
+    }
+}
+
+BlockSource::~BlockSource() {
+    stop();
+}
+
+bool BlockSource::start(const std::shared_ptr<CaptureRing> &ring, const size_t frame_size) {
+    if (m_thread.joinable()) return true;
+    if (frame_size == 0 || !is_alive()) return false;
+    {
+        std::lock_guard<std::mutex> guard(m_mutex);
+        m_stop = false;
+    }
+    m_active.store(true, std::memory_order_release);
+    m_thread = std::thread(&BlockSource::run, this, ring, frame_size);
+    return true;
+}
+
+void BlockSource::stop() {
+    if (!m_thread.joinable()) return;
+    {
+        std::lock_guard<std::mutex> guard(m_mutex);
+        m_stop = true;
+    }
+    m_wake.notify_all();
+    wake();
+    m_thread.join();
+}
+
+bool BlockSource::stop_requested() {
+    std::lock_guard<std::mutex> guard(m_mutex);
+    return m_stop;
+}
+
+void BlockSource::run(const std::shared_ptr<CaptureRing> ring, const size_t frame_size) {
+    using clock = std::chrono::steady_clock;
+    ThreadTuning::apply("audio", m_thread_policy);
+    std::vector<float> block(frame_size);
+    // Pace against the timeline of this run so a restart does not try to catch up on the time it was stopped
+    const auto started = clock::now();
+    uint64_t produced = 0;
+    clock::time_point last_block;
+
+    while (true) {
+        const auto block_start = clock::now();
+        const size_t count = produce(block.data(), block.size());
+        const auto produce_time = clock::now() - block_start;
+        if (count == 0) break;
+        produced += count;
+
+        // Like a sound card, a block is handed over once its last sample has been "captured"
+        std::unique_lock<std::mutex> lock(m_mutex);
+        if (m_speed > 0.0) {
+            const double seconds = static_cast<double>(produced) / (static_cast<double>(sample_rate()) * m_speed);
+            const auto deadline = started + std::chrono::duration_cast<clock::duration>(
+                                      std::chrono::duration<double>(seconds));
+            m_wake.wait_until(lock, deadline, [this] { return m_stop; });
+        }
+        if (m_stop) break;
+        lock.unlock();
+
+        const auto written = clock::now();
+        ring->write(block.data(), count, written);
+        m_position.fetch_add(count, std::memory_order_release);
+        CaptureStats::add(m_stats.blocks);
+        CaptureStats::add(m_stats.samples, count);
+        if (last_block != clock::time_point{}) m_stats.callback_gap.record(written - last_block);
+        last_block = written;
+        // Producing and writing the block; the pacing wait in between is the source idling, not working
+        m_stats.callback_time.record(produce_time + (clock::now() - written));
+    }
+    m_active.store(false, std::memory_order_release);
+}
\ No newline at end of file
@@ -0,0 +1,5 @@
+//
+// Created by Sebastian Sandstig on 2026-10-17.
+//
+
+#include <CaptureRing.h>
\ No newline at end of file
@@ -0,0 +1,25 @@
+//
+// Created by Sebastian Sandstig on 2026-10-17.
+//
+
+#include <CaptureStats.h>
+
+#include <cstdio>
+
+void CaptureStats::print(std::ostream &out) const {
+    const auto ms = [](const LatencyHistogram::Duration duration) {
+        return std::chrono::duration<double, std::milli>(duration).count();
+    };
+    const auto load = [](const std::atomic<uint64_t> &counter) {
+        return static_cast<unsigned long long>(counter.load(std::memory_order_relaxed));
+    };
+    char line[256];
+    std::snprintf(line, sizeof(line), "capture: %llu blocks, %llu samples, %llu overflows, %llu underflows, "
+                  "%llu zero-filled\n", load(blocks), load(samples), load(input_overflows), load(input_underflows),
+                  load(zero_filled_blocks));
+    out << line;
+    std::snprintf(line, sizeof(line), "callback time p50 %.3f p99 %.3f max %.3f ms, gap p50 %.3f p99 %.3f max %.3f ms\n",
+                  ms(callback_time.percentile(0.5)), ms(callback_time.percentile(0.99)), ms(callback_time.max()),
+                  ms(callback_gap.percentile(0.5)), ms(callback_gap.percentile(0.99)), ms(callback_gap.max()));
+    out << line;
+}
\ No newline at end of file
@@ -0,0 +1,518 @@
+//
+// Created by Sebastian Sandstig on 2026-10-17.
+//
+
+#include <DspBench.h>
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <optional>
+#include <random>
+#include <stdexcept>
+#include <thread>
+
+#include <AnalysisThread.h>
+#include <BandMapper.h>
+#include <CaptureRing.h>
+#include <MultiResolutionAnalyzer.h>
+#include <SpectrumAnalyzer.h>
+#include <SpectrumEngine.h>
+#include <Stft.h>
+#include <SyntheticSource.h>
+
+namespace {
+    // Float FFTs of up to 64k points land around 1e-6 of the peak; anything near this is a real bug
+    constexpr double FFT_TOLERANCE = 1e-4;
+
+    class Report {
+    public:
+        void check(const std::string &name, const bool passed, const std::string &detail = "") {
+            std::printf("  [%s] %s%s%s\n", passed ? " ok " : "FAIL", name.c_str(), detail.empty() ? "" : "  ",
+                        detail.c_str());
+            if (!passed) m_failures++;
+        }
+        [[nodiscard]] size_t failures() const { return m_failures; }
+    private:
+        size_t m_failures = 0;
+    };
+
+    std::string format(const char *pattern, const double value) {
+        char buffer[64];
+        std::snprintf(buffer, sizeof(buffer), pattern, value);
+        return buffer;
+    }
+
+    std::vector<float> noise(const size_t count, const uint32_t seed) {
+        std::mt19937 generator(seed);
+        std::uniform_real_distribution<float> distribution(-1.0f, 1.0f);
+        std::vector<float> samples(count);
+        for (auto &sample : samples) sample = distribution(generator);
+        return samples;
+    }
+
+    // |X[k]| of the windowed input, straight from the definition
+    double naive_bin(const std::vector<float> &samples, const std::vector<float> &window, const size_t k) {
+        const size_t n = samples.size();
+        double re = 0.0, im = 0.0;
+        for (size_t i = 0; i < n; i++) {
+            const double angle = -2.0 * M_PI * static_cast<double>((k * i) % n) / static_cast<double>(n);
+            const double x = static_cast<double>(samples[i]) * window[i];
+            re += x * std::cos(angle);
+            im += x * std::sin(angle);
+        }
+        return std::hypot(re, im);
+    }
+
+    std::vector<SpectrumEngine::Kind> engines() {
+        std::vector<SpectrumEngine::Kind> kinds = {SpectrumEngine::RADIX2, SpectrumEngine::RADIX4};
+#ifdef SOUNDSCAPE_WITH_FFTW
+        kinds.push_back(SpectrumEngine::FFTW);
+#endif
+        return kinds;
+    }
+
+    // Median seconds per call, repeating until about `budget` seconds have been spent
+    double time_per_call(const std::function<void()> &call, const double budget) {
+        using clock = std::chrono::steady_clock;
+        call();     // Warm caches and any lazy planning
+        std::vector<double> samples;
+        const auto start = clock::now();
+        while (samples.size() < 5 || (std::chrono::duration<double>(clock::now() - start).count() < budget &&
+                                      samples.size() < 1000)) {
+            const auto before = clock::now();
+            call();
+            samples.push_back(std::chrono::duration<double>(clock::now() - before).count());
+        }
+        std::ranges::nth_element(samples, samples.begin() + samples.size() / 2);
+        return samples[samples.size() / 2];
+    }
+
+    void check_engines(Report &report, const size_t max_size) {
+        std::printf("Spectrum engines against a naive DFT\n");
+        for (size_t size = 512; size <= max_size; size *= 2) {
+            const auto samples = noise(size, static_cast<uint32_t>(size));
+            const auto window = Stft::make_scaled_window(Stft::HANN, size);
+            // Every bin up to 4096 points, a spread of them above that to keep the O(n^2) reference affordable
+            std::vector<size_t> bins;
+            const size_t step = size <= 4096 ? 1 : size / 512;
+            for (size_t k = 0; k < size / 2; k += step) bins.push_back(k);
+            bins.push_back(size / 2 - 1);
+
+            std::vector<double> reference(bins.size());
+            double peak = 0.0;
+            for (size_t i = 0; i < bins.size(); i++) {
+                reference[i] = naive_bin(samples, window, bins[i]);
+                peak = std::max(peak, reference[i]);
+            }
+
+            for (const auto kind : engines()) {
+                const auto engine = SpectrumEngine::create(kind, size);
+                std::vector<float> magnitudes(engine->bin_count());
+                // Split off-centre and at an odd index, like a frame straddling the end of the ring
+                const std::span<const float> all(samples);
+                const size_t split = size / 3 | 1;
+                engine->transform(all.first(split), all.subspan(split), window, magnitudes);
+
+                double error = 0.0;
+                for (size_t i = 0; i < bins.size(); i++) {
+                    error = std::max(error, std::abs(magnitudes[bins[i]] - reference[i]));
+                }
+                report.check(std::string(SpectrumEngine::kind_name(kind)) + " " + std::to_string(size),
+                             error <= FFT_TOLERANCE * peak, format("max error %.2e of peak", error / peak));
+            }
+        }
+    }
+
+    void check_windows(Report &report) {
+        std::printf("Windowing\n");
+        const size_t size = 4096;
+        for (const auto window : {Stft::RECTANGULAR, Stft::HANN, Stft::BLACKMAN_HARRIS}) {
+            const auto coefficients = Stft::make_scaled_window(window, size);
+            double sum = 0.0;
+            for (const float coefficient : coefficients) sum += coefficient;
+
+            // A full-scale sine centred on a bin has to read as amplitude 1
+            std::vector<float> sine(size);
+            for (size_t i = 0; i < size; i++) {
+                sine[i] = static_cast<float>(std::sin(2.0 * M_PI * 100.0 * static_cast<double>(i) / size));
+            }
+            const auto engine = SpectrumEngine::create(SpectrumEngine::RADIX4, size);
+            std::vector<float> magnitudes(engine->bin_count());
+            engine->transform(sine, {}, coefficients, magnitudes);
+
+            const std::string name = window == Stft::RECTANGULAR ? "rectangular" :
+                                     window == Stft::HANN ? "hann" : "blackman-harris";
+            report.check(name + " sums to 2", std::abs(sum - 2.0) < 1e-4, format("sum %.6f", sum));
+            report.check(name + " sine reads 1", std::abs(magnitudes[100] - 1.0f) < 1e-3f,
+                         format("amplitude %.6f", magnitudes[100]));
+        }
+
+        // The sliding STFT sees the same through a ring
+        CaptureRing ring(1 << 14);
+        Stft stft(ring, size, 512, Stft::HANN, SpectrumEngine::RADIX4);
+        std::vector<float> block(512);
+        double phase = 0.0;
+        for (size_t hop = 0; hop < 16; hop++) {
+            for (auto &sample : block) {
+                sample = static_cast<float>(std::sin(phase));
+                phase += 2.0 * M_PI * 64.0 / size;
+            }
+            ring.write(block.data(), block.size());
+            stft.update();
+        }
+        report.check("stft sine reads 1", std::abs(stft.magnitudes()[64] - 1.0f) < 1e-3f,
+                     format("amplitude %.6f", stft.magnitudes()[64]));
+    }
+
+    void check_bands(Report &report) {
+        std::printf("Band mapping\n");
+        for (const auto scale : {BandMapper::LOG, BandMapper::MEL, BandMapper::CONSTANT_Q}) {
+            for (const size_t size : {512, 8192}) {
+                const BandMapper mapper(size, 24000, 32, 30.0f, 10000.0f, scale);
+                const std::vector<float> flat(size / 2, 1.0f);
+                std::vector<float> bands(mapper.band_count());
+                mapper.apply(flat, bands);
+                float error = 0.0f;
+                for (const float band : bands) error = std::max(error, std::abs(band - 1.0f));
+                report.check(std::string(BandMapper::scale_name(scale)) + " " + std::to_string(size) +
+                             " flat spectrum maps to 1", error < 1e-5f, format("max error %.2e", error));
+            }
+        }
+
+        for (const auto &entry : SpectrumAnalyzerRegistry::entries()) {
+            const auto analyzer = entry.create();
+            const auto engine = SpectrumEngine::create(SpectrumEngine::RADIX4, entry.fft_size);
+            const BandMapper mapper(entry.fft_size, entry.sample_rate, entry.bar_count,
+                                    static_cast<float>(entry.low_frequency), static_cast<float>(entry.high_frequency),
+                                    BandMapper::MEL);
+            const auto samples = noise(entry.fft_size, 7);
+            std::vector<float> expected(engine->bin_count()), expected_bars(entry.bar_count);
+            std::vector<float> magnitudes(engine->bin_count()), bars(entry.bar_count);
+            engine->transform(samples, {}, Stft::make_scaled_window(Stft::HANN, entry.fft_size), expected);
+            mapper.apply(expected, expected_bars);
+            analyzer->analyze(samples, {}, magnitudes, bars);
+
+            float error = 0.0f;
+            for (size_t bar = 0; bar < entry.bar_count; bar++) {
+                error = std::max(error, std::abs(bars[bar] - expected_bars[bar]) / expected_bars[bar]);
+            }
+            report.check("static analyzer " + std::to_string(entry.fft_size) + "x" + std::to_string(entry.bar_count) +
+                         " @ " + std::to_string(entry.sample_rate) + " matches runtime", error < 1e-4f,
+                         format("max relative error %.2e", error));
+        }
+
+        // White noise has the same level in every band, so with the default resolutions the bands on either side
+        // of a crossover have to agree once averaged over a few seconds
+        {
+            const AnalysisSettings settings;
+            auto resolutions = settings.detail_resolutions;
+            resolutions.push_back({settings.fft_size, settings.hop_size, 0.0f});
+            CaptureRing ring(2 * settings.fft_size);
+            MultiResolutionAnalyzer analyzer(ring, settings.analysis_rate, resolutions, settings.band_count,
+                                             settings.band_low_frequency, settings.band_high_frequency,
+                                             settings.band_scale, settings.window);
+            const auto samples = noise(8 * settings.analysis_rate, 11);
+            std::vector<double> totals(analyzer.band_count(), 0.0);
+            for (size_t offset = 0; offset < samples.size(); offset += 128) {
+                ring.write(samples.data() + offset, 128);
+                analyzer.update();
+                if (offset < settings.fft_size) continue;
+                for (size_t band = 0; band < totals.size(); band++) totals[band] += analyzer.band_energies()[band];
+            }
+
+            for (size_t resolution = 1; resolution < analyzer.resolution_count(); resolution++) {
+                const auto [first, last] = analyzer.band_range(resolution);
+                if (first == last || first == 0) continue;
+                const double step = 20.0 * std::log10(totals[first] / totals[first - 1]);
+                report.check("noise level across the " + std::to_string(analyzer.stft(resolution).fft_size()) +
+                             "-point crossover", std::abs(step) < 1.5, format("step %+.2f dB", step));
+            }
+        }
+    }
+
+    // A writer thread fills the ring with each sample's own cursor while this thread reads it back every way a
+    // consumer can; whatever the ring calls intact has to be exactly the samples it claims to be
+    void check_ring_concurrent(Report &report) {
+        constexpr size_t block = 256;
+        constexpr uint64_t value_mask = (1u << 24) - 1;     // Floats hold these exactly
+        const auto expected = [](const uint64_t cursor) { return static_cast<float>(cursor & value_mask); };
+
+        CaptureRing ring(4096, 4096);
+        std::atomic<bool> done = false;
+        const auto write_block = [&] {
+            std::array<float, block> samples {};
+            const uint64_t cursor = ring.write_cursor();
+            for (size_t i = 0; i < block; i++) samples[i] = expected(cursor + i);
+            // Stamped with the cursor past the block, so a reader can tell which write a stamp came from
+            const auto stamp = static_cast<std::chrono::steady_clock::rep>(cursor + block);
+            ring.write(samples.data(), block,
+                       std::chrono::steady_clock::time_point(std::chrono::steady_clock::duration(stamp)));
+        };
+        while (ring.write_cursor() < ring.capacity()) write_block();
+        std::thread writer([&] {
+            while (!done.load(std::memory_order_relaxed)) write_block();
+        });
+
+        size_t snapshots = 0, torn_snapshots = 0, windows = 0, torn_windows = 0, reads = 0, torn_reads = 0;
+        size_t copies = 0, torn_copies = 0, early_stamps = 0;
+        CaptureRing::Reader reader(ring);
+        std::vector<float> buffer(512), latest(ring.capacity() - 2 * block);
+        for (size_t round = 0; round < 50000; round++) {
+            // The whole ring: any write that begins while it is being read lands in it
+            const auto snapshot = ring.snapshot(ring.capacity());
+            bool matches = true;
+            uint64_t cursor = snapshot.sequence - ring.capacity();
+            for (const auto &piece : {snapshot.older, snapshot.newer}) {
+                for (const float sample : piece) matches &= sample == expected(cursor++);
+            }
+            if (ring.valid(snapshot)) {
+                snapshots++;
+                if (!matches) torn_snapshots++;
+            }
+
+            // The same through the contiguous view the fingerprinter reads in place
+            const auto window = ring.latest_window(ring.contiguous_capacity());
+            matches = true;
+            cursor = window.sequence - window.samples.size();
+            for (const float sample : window.samples) matches &= sample == expected(cursor++);
+            if (ring.valid(window)) {
+                windows++;
+                if (!matches) torn_windows++;
+            }
+
+            if (const size_t count = reader.read(buffer.data(), buffer.size())) {
+                reads++;
+                for (size_t i = 0; i < count; i++) {
+                    if (buffer[i] != expected(reader.cursor() - count + i)) {
+                        torn_reads++;
+                        break;
+                    }
+                }
+                // A capture stamp from a write past the samples consumed would make the capture latency negative
+                const auto stamped = static_cast<uint64_t>(reader.captured().time_since_epoch().count());
+                if (stamped > reader.cursor()) early_stamps++;
+            }
+
+            // Consecutive samples ending wherever the copy started, so checked relative to the newest one
+            if (ring.read_latest(latest.data(), latest.size())) {
+                copies++;
+                for (size_t i = 1; i < latest.size(); i++) {
+                    if (latest[i] != expected(static_cast<uint64_t>(latest.back()) - (latest.size() - 1 - i))) {
+                        torn_copies++;
+                        break;
+                    }
+                }
+            }
+        }
+        done = true;
+        writer.join();
+
+        report.check("snapshots that validate under a concurrent writer are intact", torn_snapshots == 0,
+                     std::to_string(torn_snapshots) + " torn of " + std::to_string(snapshots) + " valid");
+        report.check("windows that validate under a concurrent writer are intact", torn_windows == 0,
+                     std::to_string(torn_windows) + " torn of " + std::to_string(windows) + " valid");
+        report.check("reads under a concurrent writer are intact", reads > 0 && torn_reads == 0,
+                     std::to_string(torn_reads) + " torn of " + std::to_string(reads));
+        report.check("reader capture stamps never belong to unread samples", early_stamps == 0,
+                     std::to_string(early_stamps) + " of " + std::to_string(reads) + " reads");
+        report.check("read_latest under a concurrent writer is intact", copies > 0 && torn_copies == 0,
+                     std::to_string(torn_copies) + " torn of " + std::to_string(copies));
+        bool rejected = false;
+        try {
+            ring.read_latest(latest.data(), ring.capacity() - block);
+        } catch (const std::runtime_error &) {
+            rejected = true;
+        }
+        report.check("read_latest refuses a copy with no room for a block in progress", rejected);
+    }
+
+    void check_ring(Report &report) {
+        std::printf("Capture ring\n");
+        CaptureRing ring(1000);
+        report.check("capacity rounds up to a power of two", ring.capacity() == 1024);
+
+        // Write across the end several times and read it back in odd-sized pieces
+        CaptureRing::Reader reader(ring);
+        std::vector<float> written(3000), read(3000);
+        for (size_t i = 0; i < written.size(); i++) written[i] = static_cast<float>(i);
+        size_t produced = 0, consumed = 0;
+        while (produced < written.size()) {
+            const size_t count = std::min<size_t>(301, written.size() - produced);
+            ring.write(written.data() + produced, count);
+            produced += count;
+            consumed += reader.read(read.data() + consumed, 257);
+            consumed += reader.read(read.data() + consumed, 257);
+        }
+        while (const size_t count = reader.read(read.data() + consumed, 257)) consumed += count;
+        report.check("reader sees every sample in order across the wrap",
+                     consumed == written.size() && std::equal(written.begin(), written.end(), read.begin()));
+
+        // A reader that falls more than a ring behind skips to the oldest surviving sample
+        CaptureRing::Reader lapped(ring);
+        ring.write(written.data(), 2000);
+        float first = -1.0f;
+        lapped.read(&first, 1);
+        report.check("lapped reader resumes at the oldest surviving sample", first == 2000.0f - 1024.0f,
+                     format("got %.0f", first));
+
+        const auto snapshot = ring.snapshot(512);
+        const bool valid_before = ring.valid(snapshot);
+        ring.write(nullptr, 600);
+        report.check("snapshot stays valid until overwritten", valid_before && !ring.valid(snapshot));
+
+        // A ring of its own: the 2000-sample write above leaves no room for read_latest in this one
+        CaptureRing small_blocks(1000);
+        std::vector<float> latest(4);
+        small_blocks.write(written.data(), 300);
+        small_blocks.write(written.data(), 4);
+        report.check("read_latest returns the newest samples",
+                     small_blocks.read_latest(latest.data(), latest.size()) &&
+                     latest == std::vector<float>{0, 1, 2, 3});
+
+        check_ring_concurrent(report);
+    }
+
+    // Polls the renderer side of the analysis thread until `done` accepts a frame or `timeout` seconds pass
+    template<typename Done>
+    bool wait_for_frame(AnalysisThread &analysis, const double timeout, Done done) {
+        using clock = std::chrono::steady_clock;
+        const auto deadline = clock::now() + std::chrono::duration_cast<clock::duration>(
+                                  std::chrono::duration<double>(timeout));
+        while (clock::now() < deadline) {
+            if (const auto &frame = analysis.latest(); frame.sequence != 0 && done(frame)) return true;
+            std::this_thread::sleep_for(std::chrono::microseconds(200));
+        }
+        return false;
+    }
+
+    // Synthetic audio through the live path: capture ring -> resampler -> STFTs -> bands on the analysis thread,
+    // with the settings AudioRecord runs with by default
+    void check_pipeline(Report &report) {
+        std::printf("Live pipeline on synthetic audio\n");
+        constexpr size_t capture_rate = 48000;
+        const AnalysisSettings settings;
+        const BandMapper bands(settings.fft_size, settings.analysis_rate, settings.band_count,
+                               settings.band_low_frequency, settings.band_high_frequency, settings.band_scale);
+
+        // A 1 kHz tone has to light the band it falls in, and that one the brightest
+        {
+            const auto ring = std::make_shared<CaptureRing>(capture_rate * 2);
+            AnalysisThread analysis(ring, capture_rate, settings);
+            SyntheticSource source(capture_rate, {{.kind = SyntheticSignal::SINE, .frequency = 1000.0f}}, 0.0,
+                                   capture_rate / 2);
+            analysis.start();
+            source.start(ring, 512);
+            const uint64_t end = capture_rate / 2 * settings.analysis_rate / capture_rate;
+            const bool finished = wait_for_frame(analysis, 5.0, [&](const AnalysisFrame &frame) {
+                return frame.sample_position + settings.hop_size >= end;
+            });
+            const auto &energies = analysis.latest().band_energies;
+            const auto loudest = static_cast<size_t>(std::ranges::max_element(energies) - energies.begin());
+            report.check("1 kHz tone lights the band around 1 kHz", finished &&
+                         bands.lower_frequency(loudest) <= 1000.0f && 1000.0f <= bands.upper_frequency(loudest),
+                         format("loudest band centred at %.0f Hz", bands.center_frequency(loudest)));
+        }
+
+        // A click after half a second of silence, in real time: how far behind the click is the first frame that
+        // shows it, in audio and on the wall clock
+        {
+            const auto ring = std::make_shared<CaptureRing>(capture_rate * 2);
+            AnalysisThread analysis(ring, capture_rate, settings);
+            constexpr uint64_t click = capture_rate / 2;
+            SyntheticSource source(capture_rate, {{.kind = SyntheticSignal::CLICK, .amplitude = 1.0f,
+                                                   .start = click}}, 1.0, capture_rate);
+            analysis.start();
+            source.start(ring, 256);
+
+            using clock = std::chrono::steady_clock;
+            std::optional<clock::time_point> written;
+            uint64_t seen_at = 0;
+            const bool seen = wait_for_frame(analysis, 5.0, [&](const AnalysisFrame &frame) {
+                if (!written && source.position() > click) written = clock::now();
+                if (std::ranges::max(frame.band_energies) < 1e-4f) return false;
+                seen_at = frame.sample_position * capture_rate / settings.analysis_rate;
+                return true;
+            });
+            const double wall = written ? std::chrono::duration<double>(clock::now() - *written).count() : 0.0;
+            const double audio = seen ? static_cast<double>(seen_at) - static_cast<double>(click) : 0.0;
+            // The short transform's hop plus the resampler's delay; well under one hop of the long transform
+            const uint64_t bound = settings.hop_size * capture_rate / settings.analysis_rate;
+            report.check("click reaches the bands within one long hop", seen && seen_at > click &&
+                         seen_at - click <= bound,
+                         format("%.2f ms of audio", audio * 1e3 / capture_rate) +
+                         format(", %.2f ms wall clock", wall * 1e3));
+        }
+    }
+
+    void bench_engines(const size_t max_size, const double budget) {
+        std::printf("Transform time per frame (median)\n%8s", "points");
+        for (const auto kind : engines()) std::printf("%12s", SpectrumEngine::kind_name(kind));
+        std::printf("%12s\n", "bands");
+        for (size_t size = 512; size <= max_size; size *= 2) {
+            const auto samples = noise(size, 1);
+            const auto window = Stft::make_scaled_window(Stft::HANN, size);
+            std::printf("%8zu", size);
+            for (const auto kind : engines()) {
+                const auto engine = SpectrumEngine::create(kind, size);
+                std::vector<float> magnitudes(engine->bin_count());
+                const double seconds = time_per_call([&] {
+                    engine->transform(samples, {}, window, magnitudes);
+                }, budget);
+                std::printf("%10.1fus", seconds * 1e6);
+            }
+
+            const BandMapper mapper(size, 24000, 64, 30.0f, 10000.0f, BandMapper::MEL);
+            const std::vector<float> magnitudes(size / 2, 1.0f);
+            std::vector<float> bands(mapper.band_count());
+            const double seconds = time_per_call([&] { mapper.apply(magnitudes, bands); }, budget);
+            std::printf("%10.2fus\n", seconds * 1e6);
+        }
+    }
+}
+
+int DspBench::run(const std::vector<std::string> &args) {
+    const int checked = check(args);
+    std::printf("\n");
+    const int benched = bench(args);
+    return checked == EXIT_SUCCESS && benched == EXIT_SUCCESS ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+int DspBench::check(const std::vector<std::string> &args) {
+    const bool quick = std::ranges::find(args, "--quick") != args.end();
+    const std::vector<std::pair<std::string, std::function<void(Report&)>>> groups = {
+        {"engines", [quick](Report &report) { check_engines(report, quick ? 8192 : 65536); }},
+        {"windows", check_windows},
+        {"bands", check_bands},
+        {"ring", check_ring},
+        {"pipeline", check_pipeline},
+    };
+    std::vector<std::string> selected;
+    for (const auto &arg : args) {
+        if (arg.starts_with("--")) continue;
+        if (std::ranges::find(groups, arg, &std::pair<std::string, std::function<void(Report&)>>::first) ==
+            groups.end()) {
+            std::fprintf(stderr, "Unknown check group %s\n", arg.c_str());
+            return EXIT_FAILURE;
+        }
+        selected.push_back(arg);
+    }
+
+    Report report;
+    for (const auto &[name, group] : groups) {
+        if (selected.empty() || std::ranges::find(selected, name) != selected.end()) group(report);
+    }
+    std::printf("\n%zu check(s) failed\n", report.failures());
+    return report.failures() == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+int DspBench::bench(const std::vector<std::string> &args) {
+    const bool quick = std::ranges::find(args, "--quick") != args.end();
+    bench_engines(quick ? 8192 : 65536, quick ? 0.05 : 0.25);
+    return EXIT_SUCCESS;
+}
\ No newline at end of file
@@ -0,0 +1,92 @@
+//
+// Created by Sebastian Sandstig on 2026-10-17.
+//
+
+#include <FftwSpectrumEngine.h>
+
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <map>
+#include <mutex>
+#include <stdexcept>
+
+namespace {
+// The FFTW planner is not thread safe, executing a finished plan on other arrays is. All planning goes through here.
+class PlanCache {
+public:
+    ~PlanCache() {
+        for (const auto &[size, plan] : m_plans) {
+            fftwf_destroy_plan(plan);
+        }
+    }
+
+    fftwf_plan acquire(const size_t size) {
+        std::lock_guard guard(m_mutex);
+        if (const auto it = m_plans.find(size); it != m_plans.end()) return it->second;
+
+        if (!m_wisdom_loaded) {
+            m_wisdom_loaded = true;
+            if (!fftwf_import_wisdom_from_filename(FftwSpectrumEngine::wisdom_path().c_str())) {
+                std::cout << "No FFTW wisdom at " << FftwSpectrumEngine::wisdom_path() << ", measuring" << std::endl;
+            }
+        }
+
+        // Measuring scribbles over the arrays, so plan on scratch ones. Engines execute the plan on their own
+        // arrays, which fftwf_alloc_* gives the same alignment.
+        float *input = fftwf_alloc_real(size);
+        fftwf_complex *output = fftwf_alloc_complex(size / 2 + 1);
+        const auto plan = fftwf_plan_dft_r2c_1d(static_cast<int>(size), input, output, FFTW_MEASURE);
+        fftwf_free(input);
+        fftwf_free(output);
+        if (plan == nullptr) {
+            throw std::runtime_error("FftwSpectrumEngine: failed to create plan");
+        }
+
+        fftwf_export_wisdom_to_filename(FftwSpectrumEngine::wisdom_path().c_str());
+        m_plans[size] = plan;
+        return plan;
+    }
+private:
+    std::mutex m_mutex;
+    std::map<size_t, fftwf_plan> m_plans;
+    bool m_wisdom_loaded = false;
+};
+
+PlanCache plan_cache;
+}
+
+FftwSpectrumEngine::FftwSpectrumEngine(const size_t size) : SpectrumEngine(size),
+    m_plan(plan_cache.acquire(size)),
+    m_input(fftwf_alloc_real(size)),
+    m_output(fftwf_alloc_complex(size / 2 + 1)) {}
+
+FftwSpectrumEngine::~FftwSpectrumEngine() {
+    fftwf_free(m_input);
+    fftwf_free(m_output);
+}
+
+void FftwSpectrumEngine::transform(const std::span<const float> older, const std::span<const float> newer,
+                                   const std::span<const float> window, const std::span<float> magnitudes) {
+    if (window.empty()) {
+        std::memcpy(m_input, older.data(), older.size() * sizeof(float));
+        std::memcpy(m_input + older.size(), newer.data(), newer.size() * sizeof(float));
+    } else {
+        const float *newer_window = window.data() + older.size();
+        for (size_t i = 0; i < older.size(); i++) m_input[i] = older[i] * window[i];
+        for (size_t i = 0; i < newer.size(); i++) m_input[older.size() + i] = newer[i] * newer_window[i];
+    }
+
+    fftwf_execute_dft_r2c(m_plan, m_input, m_output);
+
+    for (size_t i = 0; i < bin_count(); i++) {
+        magnitudes[i] = std::sqrt(m_output[i][0] * m_output[i][0] + m_output[i][1] * m_output[i][1]);
+    }
+}
+
+std::string FftwSpectrumEngine::wisdom_path() {
+    if (const char *path = std::getenv("SOUNDSCAPE_FFTW_WISDOM")) return path;
+    const char *home = std::getenv("HOME");
+    return std::string(home != nullptr ? home : ".") + "/.soundscape_fftw_wisdom";
+}
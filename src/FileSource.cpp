@@ -0,0 +1,65 @@
+//
+// Created by Sebastian Sandstig on 2026-10-17.
+//
+
+#include <FileSource.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+
+#include <WavReader.h>
+
+FileSource::FileSource(const std::string &path, const double speed, const bool loop, const PcmFormat raw_format,
+                       const size_t raw_sample_rate) : BlockSource(speed), m_sample_rate(raw_sample_rate),
+    m_loop(loop)
+{
+    std::ifstream file(path, std::ios::binary | std::ios::ate);
+    if (!file) {
+        throw std::runtime_error("FileSource: cannot open " + path);
+    }
+    const auto size = static_cast<size_t>(file.tellg());
+    char header[12] = {};
+    file.seekg(0);
+    file.read(header, sizeof(header));
+
+    if (size >= sizeof(header) && std::memcmp(header, "RIFF", 4) == 0 && std::memcmp(header + 8, "WAVE", 4) == 0) {
+        file.close();
+        const WavReader wav(path);
+        m_sample_rate = wav.sample_rate();
+        m_samples = wav.samples();
+    } else {
+        if (m_sample_rate == 0) {
+            throw std::runtime_error("FileSource: raw PCM needs a sample rate");
+        }
+        std::vector<uint8_t> bytes(size);
+        file.seekg(0);
+        file.read(reinterpret_cast<char *>(bytes.data()), static_cast<std::streamsize>(bytes.size()));
+        m_samples.resize(bytes.size() / raw_format.bytes_per_frame());
+        raw_format.decode(bytes.data(), m_samples.size(), m_samples.data());
+    }
+    if (m_samples.empty()) {
+        throw std::runtime_error("FileSource: " + path + " holds no audio");
+    }
+}
+
+FileSource::~FileSource() {
+    stop();
+}
+
+size_t FileSource::produce(float *samples, const size_t count) {
+    size_t produced = 0;
+    while (produced < count) {
+        if (m_cursor == m_samples.size()) {
+            if (!m_loop) break;
+            m_cursor = 0;
+        }
+        const size_t n = std::min(count - produced, m_samples.size() - m_cursor);
+        std::copy_n(m_samples.begin() + static_cast<ptrdiff_t>(m_cursor), n, samples + produced);
+        m_cursor += n;
+        produced += n;
+    }
+    return produced;
+}
\ No newline at end of file
@@ -0,0 +1,67 @@
+//
+// Created by Sebastian Sandstig on 2026-10-17.
+//
+
+#include <LatencyHistogram.h>
+
+#include <algorithm>
+#include <bit>
+#include <cmath>
+
+void LatencyHistogram::record(const Duration duration) {
+    const int64_t nanoseconds = std::max<int64_t>(duration.count(), 0);
+    m_buckets[bucket(nanoseconds / 1000)].fetch_add(1, std::memory_order_relaxed);
+    m_sum.fetch_add(nanoseconds, std::memory_order_relaxed);
+    m_count.fetch_add(1, std::memory_order_relaxed);
+    // One writer per histogram in practice, but stay correct with more
+    int64_t max = m_max.load(std::memory_order_relaxed);
+    while (nanoseconds > max && !m_max.compare_exchange_weak(max, nanoseconds, std::memory_order_relaxed)) {}
+}
+
+LatencyHistogram::Duration LatencyHistogram::mean() const {
+    const uint64_t n = count();
+    return n == 0 ? Duration(0) : Duration(m_sum.load(std::memory_order_relaxed) / static_cast<int64_t>(n));
+}
+
+LatencyHistogram::Duration LatencyHistogram::percentile(const double fraction) const {
+    std::array<uint64_t, BUCKET_COUNT> counts {};
+    uint64_t total = 0;
+    for (size_t i = 0; i < BUCKET_COUNT; i++) {
+        counts[i] = m_buckets[i].load(std::memory_order_relaxed);
+        total += counts[i];
+    }
+    if (total == 0) return Duration(0);
+
+    const auto rank = static_cast<uint64_t>(std::ceil(std::clamp(fraction, 0.0, 1.0) * static_cast<double>(total)));
+    uint64_t seen = 0;
+    for (size_t i = 0; i < BUCKET_COUNT; i++) {
+        seen += counts[i];
+        if (seen >= std::max<uint64_t>(rank, 1)) {
+            return std::min(Duration(bucket_upper(i) * 1000), max());
+        }
+    }
+    return max();
+}
+
+void LatencyHistogram::reset() {
+    for (auto &bucket : m_buckets) bucket.store(0, std::memory_order_relaxed);
+    m_count.store(0, std::memory_order_relaxed);
+    m_sum.store(0, std::memory_order_relaxed);
+    m_max.store(0, std::memory_order_relaxed);
+}
+
+size_t LatencyHistogram::bucket(const int64_t microseconds) {
+    // The first octave holds 0..7 us linearly, above that the top three bits below the leading one pick the bucket
+    if (microseconds < static_cast<int64_t>(SUB_BUCKETS)) return static_cast<size_t>(microseconds);
+    const auto value = static_cast<uint64_t>(microseconds);
+    const size_t octave = std::bit_width(value) - 3;        // 8..15 us is octave 1
+    const size_t sub = (value >> (octave - 1)) & (SUB_BUCKETS - 1);
+    return std::min(octave * SUB_BUCKETS + sub, BUCKET_COUNT - 1);
+}
+
+int64_t LatencyHistogram::bucket_upper(const size_t bucket) {
+    if (bucket < SUB_BUCKETS) return static_cast<int64_t>(bucket) + 1;
+    const size_t octave = bucket / SUB_BUCKETS;
+    const size_t sub = bucket % SUB_BUCKETS;
+    return static_cast<int64_t>((SUB_BUCKETS + sub + 1) << (octave - 1));
+}
\ No newline at end of file
@@ -0,0 +1,96 @@
+//
+// Created by Sebastian Sandstig on 2026-10-17.
+//
+
+#include <MultiResolutionAnalyzer.h>
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+namespace {
+    // A band read from fewer bins than this is just one bin smeared by the window
+    constexpr float MIN_BINS_PER_BAND = 2.0f;
+}
+
+MultiResolutionAnalyzer::MultiResolutionAnalyzer(const CaptureRing &ring, const size_t sample_rate,
+                                                 std::vector<SpectrumResolution> resolutions, const size_t band_count,
+                                                 const float low_frequency, const float high_frequency,
+                                                 const BandMapper::Scale scale, const Stft::Window window,
+                                                 const SpectrumEngine::Kind engine)
+{
+    if (resolutions.empty()) {
+        throw std::runtime_error("MultiResolutionAnalyzer: at least one resolution is needed");
+    }
+    std::ranges::sort(resolutions, std::greater{}, &SpectrumResolution::fft_size);
+
+    m_resolutions.reserve(resolutions.size());
+    const auto primary_size = static_cast<float>(resolutions.front().fft_size);
+    for (const auto &resolution : resolutions) {
+        m_resolutions.push_back(Resolution {
+            .stft = Stft(ring, resolution.fft_size, resolution.hop_size, window, engine),
+            .bands = BandMapper(resolution.fft_size, sample_rate, band_count, low_frequency, high_frequency, scale),
+            .low_frequency = resolution.low_frequency,
+            .gain = std::sqrt(static_cast<float>(resolution.fft_size) / primary_size),
+        });
+    }
+    m_band_energies.resize(band_count);
+    assign_bands();
+}
+
+bool MultiResolutionAnalyzer::update() {
+    bool updated = false;
+    for (size_t i = 0; i < m_resolutions.size(); i++) {
+        auto &resolution = m_resolutions[i];
+        // Transforms that own no bands are skipped, except the primary whose magnitudes are published
+        if (resolution.first_band == resolution.last_band && i != 0) continue;
+        if (!resolution.stft.update()) continue;
+
+        resolution.bands.apply(resolution.stft.magnitudes(), m_band_energies, resolution.first_band,
+                               resolution.last_band);
+        if (resolution.gain != 1.0f) {
+            for (size_t band = resolution.first_band; band < resolution.last_band; band++) {
+                m_band_energies[band] *= resolution.gain;
+            }
+        }
+        m_frame_end = std::max(m_frame_end, resolution.stft.frame_end());
+        updated = true;
+    }
+    return updated;
+}
+
+void MultiResolutionAnalyzer::set_band_count(const size_t band_count) {
+    if (band_count == m_band_energies.size()) return;
+    for (auto &resolution : m_resolutions) {
+        resolution.bands.set_band_count(band_count);
+    }
+    m_band_energies.assign(band_count, 0.0f);
+    assign_bands();
+}
+
+void MultiResolutionAnalyzer::assign_bands() {
+    for (auto &resolution : m_resolutions) {
+        resolution.first_band = resolution.last_band = 0;
+    }
+
+    // Bands rise in frequency, so the chosen transform may only get shorter from one band to the next
+    size_t chosen = 0;
+    for (size_t band = 0; band < m_band_energies.size(); band++) {
+        const auto &mapper = m_resolutions.front().bands;
+        const float center = mapper.center_frequency(band);
+        const float width = mapper.upper_frequency(band) - mapper.lower_frequency(band);
+        for (size_t i = m_resolutions.size() - 1; i > chosen; i--) {
+            const auto &candidate = m_resolutions[i].bands;
+            const float bin_width = static_cast<float>(candidate.sample_rate()) /
+                                    static_cast<float>(candidate.fft_size());
+            if (center >= m_resolutions[i].low_frequency && width >= MIN_BINS_PER_BAND * bin_width) {
+                chosen = i;
+                break;
+            }
+        }
+
+        auto &resolution = m_resolutions[chosen];
+        if (resolution.first_band == resolution.last_band) resolution.first_band = band;
+        resolution.last_band = band + 1;
+    }
+}
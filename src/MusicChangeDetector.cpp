@@ -0,0 +1,116 @@
+//
+// Created by Sebastian Sandstig on 2026-10-17.
+//
+
+#include <MusicChangeDetector.h>
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+namespace {
+    // Pitch classes below this are mostly rumble and too few bins wide per semitone, above it mostly overtones
+    constexpr float MIN_PITCH_FREQUENCY = 80.0f;
+    constexpr float MAX_PITCH_FREQUENCY = 5000.0f;
+    // Hysteresis: quieter than the first starts silence, louder than the second ends it
+    constexpr float SILENCE_LEVEL = -60.0f;
+    constexpr float SOUND_LEVEL = -54.0f;
+    constexpr float SILENCE_SECONDS = 0.5f;
+    constexpr float GAP_SECONDS = 1.5f;             // Silence that ends a piece, e.g. between two tracks
+    constexpr float SOUND_SECONDS = 1.0f;           // Sound needed after a gap before it counts as a new piece
+    constexpr float RECENT_SECONDS = 3.0f;          // Time constant of the "now" chroma
+    constexpr float PIECE_SECONDS = 30.0f;          // ... and of the current piece's
+    constexpr float SETTLE_SECONDS = 10.0f;         // After a change, how long the piece's chroma takes to form
+    constexpr float NOVELTY_THRESHOLD = 0.3f;
+    constexpr float NOVELTY_SECONDS = 2.0f;         // How long novelty must stay above the threshold
+}
+
+MusicChangeDetector::MusicChangeDetector(const size_t bin_count, const float bin_width, const float frame_rate)
+    : m_frame_rate(frame_rate), m_pitch_class(bin_count, -1)
+{
+    if (bin_width <= 0.0f || frame_rate <= 0.0f) {
+        throw std::runtime_error("MusicChangeDetector: bin_width and frame_rate must be positive");
+    }
+    for (size_t bin = 0; bin < bin_count; bin++) {
+        const float frequency = static_cast<float>(bin) * bin_width;
+        if (frequency < MIN_PITCH_FREQUENCY || frequency > MAX_PITCH_FREQUENCY) continue;
+        // Semitones from A440, folded into an octave with A as 0
+        const long semitone = std::lround(12.0f * std::log2(frequency / 440.0f));
+        m_pitch_class[bin] = static_cast<int8_t>(((semitone % 12) + 12) % 12);
+    }
+    m_recent_decay = std::exp(-1.0f / (frame_rate * RECENT_SECONDS));
+    m_piece_decay = std::exp(-1.0f / (frame_rate * PIECE_SECONDS));
+}
+
+size_t MusicChangeDetector::hops(const float seconds) const {
+    return std::max<size_t>(static_cast<size_t>(seconds * m_frame_rate), 1);
+}
+
+bool MusicChangeDetector::process(const std::span<const float> magnitudes) {
+    const size_t bins = std::min(magnitudes.size(), m_pitch_class.size());
+    float energy = 0.0f;
+    Chroma chroma {};
+    for (size_t bin = 0; bin < bins; bin++) {
+        energy += magnitudes[bin] * magnitudes[bin];
+        if (m_pitch_class[bin] >= 0) chroma[m_pitch_class[bin]] += magnitudes[bin];
+    }
+    m_state.level = 10.0f * std::log10(energy + 1e-12f);
+    m_hops_since_change++;
+
+    const bool quiet = m_state.level < (m_state.silent ? SOUND_LEVEL : SILENCE_LEVEL);
+    if (quiet) {
+        m_silent_hops++;
+        m_sound_hops = 0;
+    } else {
+        m_sound_hops++;
+        m_silent_hops = 0;
+    }
+    if (!m_state.silent && m_silent_hops >= hops(SILENCE_SECONDS)) m_state.silent = true;
+    // Starting out counts as a gap, so the first music heard is a change too
+    if (m_state.silent && (m_silent_hops >= hops(GAP_SECONDS) || m_state.change_count == 0)) m_gap = true;
+    if (m_state.silent && m_sound_hops >= hops(SOUND_SECONDS)) {
+        m_state.silent = false;
+        if (m_gap) {
+            fire();
+            return true;
+        }
+    }
+    if (quiet) return false;
+
+    float norm = 0.0f;
+    for (const float value : chroma) norm += value * value;
+    if (norm <= 0.0f) return false;
+    norm = 1.0f / std::sqrt(norm);
+
+    float dot = 0.0f, recent_norm = 0.0f, piece_norm = 0.0f;
+    for (size_t pitch = 0; pitch < chroma.size(); pitch++) {
+        m_recent[pitch] = m_recent_decay * m_recent[pitch] + (1.0f - m_recent_decay) * chroma[pitch] * norm;
+        m_piece[pitch] = m_piece_decay * m_piece[pitch] + (1.0f - m_piece_decay) * chroma[pitch] * norm;
+        dot += m_recent[pitch] * m_piece[pitch];
+        recent_norm += m_recent[pitch] * m_recent[pitch];
+        piece_norm += m_piece[pitch] * m_piece[pitch];
+    }
+    m_state.novelty = recent_norm > 0.0f && piece_norm > 0.0f
+                          ? std::clamp(1.0f - dot / std::sqrt(recent_norm * piece_norm), 0.0f, 1.0f)
+                          : 0.0f;
+
+    if (m_hops_since_change >= hops(SETTLE_SECONDS) && m_state.novelty > NOVELTY_THRESHOLD) {
+        m_novel_hops++;
+    } else {
+        m_novel_hops = 0;
+    }
+    if (m_novel_hops >= hops(NOVELTY_SECONDS)) {
+        fire();
+        return true;
+    }
+    return false;
+}
+
+void MusicChangeDetector::fire() {
+    m_state.change_count++;
+    m_gap = false;
+    // The new piece's chroma builds up from here; the recent one already leans towards it
+    m_piece = {};
+    m_novel_hops = 0;
+    m_hops_since_change = 0;
+}
\ No newline at end of file
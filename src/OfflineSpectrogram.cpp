@@ -0,0 +1,167 @@
+//
+// Created by Sebastian Sandstig on 2026-10-17.
+//
+
+#include <OfflineSpectrogram.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <memory>
+#include <stdexcept>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include <SpectrumAnalyzer.h>
+#include <ThreadPool.h>
+
+namespace {
+    // A file of a fixed size mapped read-write; unmapped and closed on destruction
+    class MappedFile {
+    public:
+        MappedFile(const std::string &path, const size_t size) : m_size(size) {
+            m_fd = ::open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+            if (m_fd < 0) {
+                throw std::runtime_error("OfflineSpectrogram: cannot create " + path + ": " + std::strerror(errno));
+            }
+            if (::ftruncate(m_fd, static_cast<off_t>(size)) != 0) {
+                ::close(m_fd);
+                throw std::runtime_error("OfflineSpectrogram: cannot size " + path + ": " + std::strerror(errno));
+            }
+            m_data = ::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, m_fd, 0);
+            if (m_data == MAP_FAILED) {
+                ::close(m_fd);
+                throw std::runtime_error("OfflineSpectrogram: cannot map " + path + ": " + std::strerror(errno));
+            }
+        }
+        ~MappedFile() {
+            ::munmap(m_data, m_size);
+            ::close(m_fd);
+        }
+
+        MappedFile(const MappedFile&) = delete;
+        MappedFile& operator=(const MappedFile&) = delete;
+
+        [[nodiscard]] uint8_t* data() const { return static_cast<uint8_t *>(m_data); }
+    private:
+        int m_fd;
+        void *m_data;
+        size_t m_size;
+    };
+
+    constexpr size_t CACHE_LINE = 64;
+
+    size_t align_up(const size_t value, const size_t alignment) {
+        return (value + alignment - 1) / alignment * alignment;
+    }
+
+    // Floats per row once `count` of them are padded to whole cache lines
+    size_t row_stride(const size_t count) {
+        return align_up(count * sizeof(float), CACHE_LINE) / sizeof(float);
+    }
+}
+
+OfflineSpectrogram::Header OfflineSpectrogram::render(const std::span<const float> samples, const size_t sample_rate,
+                                                      const std::string &output_path,
+                                                      const SpectrogramSettings &settings)
+{
+    const size_t fft_size = settings.fft_size;
+    const size_t hop_size = settings.hop_size;
+    if (hop_size == 0 || hop_size > fft_size) {
+        throw std::runtime_error("OfflineSpectrogram: hop_size must be in [1, fft_size]");
+    }
+    const size_t bin_count = fft_size / 2;
+    const size_t bin_stride = row_stride(bin_count);
+    const size_t frame_count = std::max<size_t>((samples.size() + hop_size - 1) / hop_size, 1);
+
+    const BandMapper bands(fft_size, sample_rate, settings.band_count, settings.band_low_frequency,
+                           settings.band_high_frequency, settings.band_scale);
+    const auto window = Stft::make_scaled_window(settings.window, fft_size);
+    const size_t band_stride = row_stride(bands.band_count());
+
+    Header header {
+        .magic = {'S', 'S', 'S', 'P', 'E', 'C', 'T', '\0'},
+        .version = VERSION,
+        .sample_rate = static_cast<uint32_t>(sample_rate),
+        .fft_size = static_cast<uint32_t>(fft_size),
+        .hop_size = static_cast<uint32_t>(hop_size),
+        .bin_count = static_cast<uint32_t>(bin_count),
+        .band_count = static_cast<uint32_t>(bands.band_count()),
+        .window = static_cast<uint32_t>(settings.window),
+        .band_scale = static_cast<uint32_t>(settings.band_scale),
+        .band_low_frequency = settings.band_low_frequency,
+        .band_high_frequency = bands.high_frequency(),
+        .bin_stride = static_cast<uint32_t>(bin_stride),
+        .band_stride = static_cast<uint32_t>(band_stride),
+        .frame_count = frame_count,
+    };
+    // Both sections and, through the strides, every row in them start on a cache line, so neighbouring workers
+    // never write the same line
+    header.magnitudes_offset = align_up(sizeof(Header), CACHE_LINE);
+    header.bands_offset = header.magnitudes_offset + frame_count * bin_stride * sizeof(float);
+    const size_t file_size = header.bands_offset + frame_count * band_stride * sizeof(float);
+
+    const MappedFile file(output_path, file_size);
+    std::memcpy(file.data(), &header, sizeof(header));
+    auto *magnitudes = reinterpret_cast<float *>(file.data() + header.magnitudes_offset);
+    auto *band_energies = reinterpret_cast<float *>(file.data() + header.bands_offset);
+
+    ThreadPool pool(settings.thread_count);
+    struct Worker {
+        std::unique_ptr<SpectrumEngine> engine;
+        std::unique_ptr<StaticAnalyzer> analyzer;   // Replaces engine + band mapper when set
+        std::vector<float> padded;                  // Frames hanging off either end of the input
+    };
+    const bool static_possible = settings.prefer_static_analyzer && settings.window == Stft::HANN &&
+                                 settings.band_scale == BandMapper::MEL;
+    std::vector<Worker> workers(pool.thread_count());
+    for (auto &worker : workers) {
+        if (static_possible) {
+            worker.analyzer = SpectrumAnalyzerRegistry::create(fft_size, settings.band_count, sample_rate,
+                                                               settings.band_low_frequency,
+                                                               settings.band_high_frequency);
+        }
+        if (worker.analyzer == nullptr) {
+            worker.engine = SpectrumEngine::create(settings.spectrum_engine, fft_size);
+        }
+        worker.padded.resize(fft_size);
+    }
+
+    const size_t frames_per_chunk = std::max<size_t>(settings.frames_per_chunk, 1);
+    const size_t chunk_count = (frame_count + frames_per_chunk - 1) / frames_per_chunk;
+    pool.parallel_for(chunk_count, [&](const size_t chunk, const size_t worker_index) {
+        auto &worker = workers[worker_index];
+        const size_t last = std::min((chunk + 1) * frames_per_chunk, frame_count);
+        for (size_t frame = chunk * frames_per_chunk; frame < last; frame++) {
+            // Signed: the first frames start before the input does
+            const auto end = static_cast<ptrdiff_t>((frame + 1) * hop_size);
+            const ptrdiff_t start = end - static_cast<ptrdiff_t>(fft_size);
+            std::span<const float> input;
+            if (start >= 0 && static_cast<size_t>(end) <= samples.size()) {
+                input = samples.subspan(start, fft_size);
+            } else {
+                std::ranges::fill(worker.padded, 0.0f);
+                const ptrdiff_t from = std::max<ptrdiff_t>(start, 0);
+                const ptrdiff_t to = std::min<ptrdiff_t>(end, static_cast<ptrdiff_t>(samples.size()));
+                if (to > from) {
+                    std::copy(samples.begin() + from, samples.begin() + to, worker.padded.begin() + (from - start));
+                }
+                input = worker.padded;
+            }
+
+            const std::span<float> row(magnitudes + frame * bin_stride, bin_count);
+            const std::span<float> band_row(band_energies + frame * band_stride, bands.band_count());
+            if (worker.analyzer != nullptr) {
+                worker.analyzer->analyze(input, {}, row, band_row);
+                continue;
+            }
+            worker.engine->transform(input, {}, window, row);
+            bands.apply(row, band_row);
+        }
+    });
+
+    return header;
+}
@@ -0,0 +1,93 @@
+//
+// Created by Sebastian Sandstig on 2026-10-17.
+//
+
+#include <PcmFormat.h>
+
+#include <cstring>
+
+namespace {
+    // Little endian whatever the host is
+    uint32_t read_u32(const uint8_t *p) {
+        return p[0] | (p[1] << 8) | (p[2] << 16) | (static_cast<uint32_t>(p[3]) << 24);
+    }
+    uint16_t read_u16(const uint8_t *p) {
+        return static_cast<uint16_t>(p[0] | (p[1] << 8));
+    }
+
+    float decode_sample(const uint8_t *p, const PcmFormat::Encoding encoding) {
+        switch (encoding) {
+            case PcmFormat::U8:
+                return (static_cast<float>(p[0]) - 128.0f) / 128.0f;
+            case PcmFormat::S16:
+                return static_cast<float>(static_cast<int16_t>(read_u16(p))) / 32768.0f;
+            case PcmFormat::S24: {
+                const int32_t value = static_cast<int32_t>((p[0] << 8) | (p[1] << 16) | (static_cast<uint32_t>(p[2]) << 24)) >> 8;
+                return static_cast<float>(value) / 8388608.0f;
+            }
+            case PcmFormat::S32:
+                return static_cast<float>(static_cast<int32_t>(read_u32(p))) / 2147483648.0f;
+            case PcmFormat::F32: {
+                const uint32_t raw = read_u32(p);
+                float value;
+                std::memcpy(&value, &raw, sizeof(value));
+                return value;
+            }
+            case PcmFormat::F64: {
+                const uint64_t raw = read_u32(p) | (static_cast<uint64_t>(read_u32(p + 4)) << 32);
+                double value;
+                std::memcpy(&value, &raw, sizeof(value));
+                return static_cast<float>(value);
+            }
+        }
+        return 0.0f;
+    }
+}
+
+size_t PcmFormat::bytes_per_sample() const {
+    switch (encoding) {
+        case U8: return 1;
+        case S16: return 2;
+        case S24: return 3;
+        case S32: case F32: return 4;
+        case F64: return 8;
+    }
+    return 0;
+}
+
+void PcmFormat::decode(const uint8_t *bytes, const size_t frame_count, float *samples, size_t frame_stride) const {
+    if (frame_stride == 0) frame_stride = bytes_per_frame();
+    const size_t sample_bytes = bytes_per_sample();
+    const float scale = 1.0f / static_cast<float>(channel_count);
+    for (size_t frame = 0; frame < frame_count; frame++) {
+        const uint8_t *p = bytes + frame * frame_stride;
+        if (channel_count == 1) {
+            samples[frame] = decode_sample(p, encoding);
+            continue;
+        }
+        float sum = 0.0f;
+        for (size_t channel = 0; channel < channel_count; channel++) {
+            sum += decode_sample(p + channel * sample_bytes, encoding);
+        }
+        samples[frame] = sum * scale;
+    }
+}
+
+const char* PcmFormat::encoding_name(const Encoding encoding) {
+    switch (encoding) {
+        case U8: return "u8";
+        case S16: return "s16";
+        case S24: return "s24";
+        case S32: return "s32";
+        case F32: return "f32";
+        case F64: return "f64";
+    }
+    return "unknown";
+}
+
+std::optional<PcmFormat::Encoding> PcmFormat::parse_encoding(const std::string &name) {
+    for (const auto encoding : {U8, S16, S24, S32, F32, F64}) {
+        if (name == encoding_name(encoding)) return encoding;
+    }
+    return std::nullopt;
+}
\ No newline at end of file
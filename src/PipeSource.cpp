@@ -0,0 +1,97 @@
+//
+// Created by Sebastian Sandstig on 2026-10-17.
+//
+
+#include <PipeSource.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+PipeSource::PipeSource(const std::string &path, const size_t sample_rate, const PcmFormat format) : BlockSource(0.0),
+    m_path(path), m_sample_rate(sample_rate), m_format(format)
+{
+    if (m_sample_rate == 0) {
+        throw std::runtime_error("PipeSource: sample_rate must not be 0");
+    }
+    if (pipe(m_wake_pipe) != 0) {
+        throw std::runtime_error(std::string("PipeSource: pipe: ") + std::strerror(errno));
+    }
+    for (const int fd : m_wake_pipe) fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+    if (!open_input()) {
+        throw std::runtime_error("PipeSource: cannot open " + m_path + ": " + std::strerror(errno));
+    }
+}
+
+PipeSource::~PipeSource() {
+    stop();
+    if (m_fd > STDIN_FILENO) close(m_fd);
+    close(m_wake_pipe[0]);
+    close(m_wake_pipe[1]);
+}
+
+bool PipeSource::open_input() {
+    if (m_path == "-") {
+        m_fd = STDIN_FILENO;
+        return true;
+    }
+    // Non-blocking so opening a named pipe does not wait for its writer; poll() does the waiting instead
+    m_fd = open(m_path.c_str(), O_RDONLY | O_NONBLOCK);
+    if (m_fd < 0) return false;
+    struct stat info {};
+    m_fifo = fstat(m_fd, &info) == 0 && S_ISFIFO(info.st_mode);
+    return true;
+}
+
+void PipeSource::wake() {
+    const char byte = 1;
+    [[maybe_unused]] const auto written = write(m_wake_pipe[1], &byte, 1);
+}
+
+bool PipeSource::wait_for_wake(const int timeout_ms) {
+    pollfd wake {m_wake_pipe[0], POLLIN, 0};
+    if (poll(&wake, 1, timeout_ms) <= 0) return false;
+    char drain[16];
+    while (read(m_wake_pipe[0], drain, sizeof(drain)) > 0) {}
+    return true;
+}
+
+size_t PipeSource::produce(float *samples, const size_t count) {
+    const size_t frame_bytes = m_format.bytes_per_frame();
+    m_bytes.resize(count * frame_bytes);
+
+    while (m_pending < frame_bytes) {
+        pollfd fds[2] = {{m_fd, POLLIN, 0}, {m_wake_pipe[0], POLLIN, 0}};
+        if (poll(fds, 2, -1) < 0) {
+            if (errno == EINTR) continue;
+            return 0;
+        }
+        // A wake left over from a stop() that found nothing blocked is not a reason to end this run
+        if (fds[1].revents != 0 && wait_for_wake(0) && stop_requested()) return 0;
+        if (fds[0].revents == 0) continue;
+
+        const ssize_t n = read(m_fd, m_bytes.data() + m_pending, m_bytes.size() - m_pending);
+        if (n > 0) {
+            m_pending += static_cast<size_t>(n);
+        } else if (n == 0 || (errno != EAGAIN && errno != EINTR)) {
+            if (!m_fifo) return 0;
+            // The writer went away: give it a moment, then wait for the next one on a fresh descriptor
+            if (wait_for_wake(100) && stop_requested()) return 0;
+            close(m_fd);
+            if (!open_input()) return 0;
+        }
+    }
+
+    const size_t frames = std::min(count, m_pending / frame_bytes);
+    m_format.decode(m_bytes.data(), frames, samples);
+    const size_t used = frames * frame_bytes;
+    std::memmove(m_bytes.data(), m_bytes.data() + used, m_pending - used);
+    m_pending -= used;
+    return frames;
+}
\ No newline at end of file
@@ -0,0 +1,37 @@
+//
+// Created by Sebastian Sandstig on 2026-10-17.
+//
+
+#include <PipelineLatency.h>
+
+#include <cstdio>
+
+void PipelineLatency::print(std::ostream &out) const {
+    const auto ms = [](const LatencyHistogram::Duration duration) {
+        return std::chrono::duration<double, std::milli>(duration).count();
+    };
+    char line[128];
+    std::snprintf(line, sizeof(line), "%-9s %8s %9s %9s %9s %9s\n", "stage", "count", "p50 ms", "p90 ms", "p99 ms",
+                  "max ms");
+    out << line;
+    for (size_t i = 0; i < STAGE_COUNT; i++) {
+        const auto &histogram = m_stages[i];
+        std::snprintf(line, sizeof(line), "%-9s %8llu %9.2f %9.2f %9.2f %9.2f\n", stage_name(static_cast<Stage>(i)),
+                      static_cast<unsigned long long>(histogram.count()), ms(histogram.percentile(0.5)),
+                      ms(histogram.percentile(0.9)), ms(histogram.percentile(0.99)), ms(histogram.max()));
+        out << line;
+    }
+}
+
+const char* PipelineLatency::stage_name(const Stage stage) {
+    switch (stage) {
+        case CAPTURE: return "capture";
+        case ANALYSIS: return "analysis";
+        case UPDATE: return "update";
+        case PRESENT: return "present";
+        case GPU: return "gpu";
+        case TOTAL: return "total";
+        case STAGE_COUNT: break;
+    }
+    return "unknown";
+}
\ No newline at end of file
@@ -0,0 +1,95 @@
+//
+// Created by Sebastian Sandstig on 2026-10-17.
+//
+
+#include <PortAudioSource.h>
+
+#include <cstdio>
+
+PortAudioSource::PortAudioSource(const size_t sample_rate) : m_sample_rate(sample_rate) {
+    m_err = Pa_Initialize();
+    m_input_parameters = {};
+    m_input_parameters.device = m_err == paNoError ? Pa_GetDefaultInputDevice() : paNoDevice;
+    if (m_sample_rate == 0) {
+        m_sample_rate = m_input_parameters.device != paNoDevice
+                            ? static_cast<size_t>(Pa_GetDeviceInfo(m_input_parameters.device)->defaultSampleRate)
+                            : 44100;
+    }
+
+    if(m_err != paNoError) {
+        m_is_alive = false;
+        return;
+    }
+
+    if (m_input_parameters.device == paNoDevice) {
+        fprintf(stderr,"Error: No default input device.\n");
+        m_is_alive = false;
+        return;
+    }
+    m_input_parameters.channelCount = 1;
+    m_input_parameters.sampleFormat = paFloat32;
+    m_input_parameters.suggestedLatency = Pa_GetDeviceInfo(m_input_parameters.device)->defaultLowInputLatency;
+    m_input_parameters.hostApiSpecificStreamInfo = nullptr;
+}
+
+PortAudioSource::~PortAudioSource() {
+    stop();
+    Pa_Terminate();
+    if(m_err != paNoError)
+    {
+        fprintf( stderr, "An error occurred while using the portaudio stream\n" );
+        fprintf( stderr, "Error number: %d\n", m_err );
+        fprintf( stderr, "Error message: %s\n", Pa_GetErrorText( m_err ) );
+        m_err = 1;          /* Always return 0 or 1, but no other return codes. */
+    }
+    delete m_arc;
+}
+
+bool PortAudioSource::is_active() const {
+    PaStream *stream = m_stream.load(std::memory_order_acquire);
+    return m_is_alive && stream != nullptr && Pa_IsStreamActive(stream) == 1;
+}
+
+// PortAudio runs the callback on a thread of its own, so there is nothing for a thread of ours to do: the stream is
+// opened and started here and stopped in stop(), both of which return as soon as the host API has done so
+bool PortAudioSource::start(const std::shared_ptr<CaptureRing> &ring, const size_t frame_size) {
+    if (!m_is_alive) return false;
+    if (m_stream.load(std::memory_order_relaxed) != nullptr) return true;
+    delete m_arc;
+    m_arc = new AudioRecordCallback(ring, m_sample_rate, m_stats, m_thread_policy);
+
+    PaStream *stream = nullptr;
+    PaError err = Pa_OpenStream(
+        &stream,
+        &m_input_parameters,
+        nullptr, /* &outputParameters, */
+        static_cast<double>(m_sample_rate),
+        frame_size,
+        paClipOff, /* we won't output out of range samples so don't bother clipping them */
+        &callback,
+        m_arc);
+    if(err != paNoError) {
+        fprintf(stderr, "Error opening the input stream: %s\n", Pa_GetErrorText(err));
+        return false;
+    }
+
+    err = Pa_StartStream(stream);
+    if( err != paNoError ) {
+        fprintf(stderr, "Error starting the input stream: %s\n", Pa_GetErrorText(err));
+        Pa_CloseStream(stream);
+        return false;
+    }
+    m_stream.store(stream, std::memory_order_release);
+    return true;
+}
+
+void PortAudioSource::stop() {
+    PaStream *stream = m_stream.exchange(nullptr, std::memory_order_acq_rel);
+    if (stream == nullptr) return;
+    // The callback finishes the stream on its next buffer; Pa_StopStream returns once that buffer is through
+    m_arc->stop_recording();
+    if (const PaError err = Pa_StopStream(stream); err != paNoError) {
+        fprintf(stderr, "Error stopping the input stream: %s\n", Pa_GetErrorText(err));
+    }
+    Pa_CloseStream(stream);
+}
\ No newline at end of file
@@ -0,0 +1,296 @@
+//
+// Created by Sebastian Sandstig on 2026-10-17.
+//
+
+#include <Radix4SpectrumEngine.h>
+
+#include <bit>
+#include <cmath>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#endif
+#if defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
+namespace {
+// Radix-4 decimation in time on bit-reversed input. A block of 4q points holds the q-point transforms A, B, C, D of
+// the samples congruent to 0, 2, 1, 3 (mod 4), so with W = exp(-2 pi i / 4q) and b = W^2j B, c = W^j C, d = W^3j D:
+//   X[j] = a + b + c + d        X[j + q] = a - b - i(c - d)
+//   X[j + 2q] = a + b - c - d   X[j + 3q] = a - b + i(c - d)
+void radix4_stage_scalar(float *re, float *im, const size_t count, const size_t quarter, const float *twiddles) {
+    const float *w2_re = twiddles, *w2_im = twiddles + quarter;
+    const float *w1_re = twiddles + 2 * quarter, *w1_im = twiddles + 3 * quarter;
+    const float *w3_re = twiddles + 4 * quarter, *w3_im = twiddles + 5 * quarter;
+
+    for (size_t k = 0; k < count; k += 4 * quarter) {
+        float *a_re = re + k, *b_re = a_re + quarter, *c_re = b_re + quarter, *d_re = c_re + quarter;
+        float *a_im = im + k, *b_im = a_im + quarter, *c_im = b_im + quarter, *d_im = c_im + quarter;
+        for (size_t j = 0; j < quarter; j++) {
+            const float br = b_re[j] * w2_re[j] - b_im[j] * w2_im[j];
+            const float bi = b_re[j] * w2_im[j] + b_im[j] * w2_re[j];
+            const float cr = c_re[j] * w1_re[j] - c_im[j] * w1_im[j];
+            const float ci = c_re[j] * w1_im[j] + c_im[j] * w1_re[j];
+            const float dr = d_re[j] * w3_re[j] - d_im[j] * w3_im[j];
+            const float di = d_re[j] * w3_im[j] + d_im[j] * w3_re[j];
+
+            const float t0r = a_re[j] + br, t0i = a_im[j] + bi;
+            const float t1r = a_re[j] - br, t1i = a_im[j] - bi;
+            const float t2r = cr + dr, t2i = ci + di;
+            const float t3r = cr - dr, t3i = ci - di;
+
+            a_re[j] = t0r + t2r; a_im[j] = t0i + t2i;
+            b_re[j] = t1r + t3i; b_im[j] = t1i - t3r;
+            c_re[j] = t0r - t2r; c_im[j] = t0i - t2i;
+            d_re[j] = t1r - t3i; d_im[j] = t1i + t3r;
+        }
+    }
+}
+
+#if defined(__x86_64__) || defined(__i386__)
+__attribute__((target("avx2,fma")))
+void radix4_stage_avx2(float *re, float *im, const size_t count, const size_t quarter, const float *twiddles) {
+    if (quarter < 8) {
+        radix4_stage_scalar(re, im, count, quarter, twiddles);
+        return;
+    }
+    const float *w2_re = twiddles, *w2_im = twiddles + quarter;
+    const float *w1_re = twiddles + 2 * quarter, *w1_im = twiddles + 3 * quarter;
+    const float *w3_re = twiddles + 4 * quarter, *w3_im = twiddles + 5 * quarter;
+
+    for (size_t k = 0; k < count; k += 4 * quarter) {
+        float *a_re = re + k, *b_re = a_re + quarter, *c_re = b_re + quarter, *d_re = c_re + quarter;
+        float *a_im = im + k, *b_im = a_im + quarter, *c_im = b_im + quarter, *d_im = c_im + quarter;
+        for (size_t j = 0; j < quarter; j += 8) {
+            const __m256 ar = _mm256_loadu_ps(a_re + j), ai = _mm256_loadu_ps(a_im + j);
+            const __m256 b0r = _mm256_loadu_ps(b_re + j), b0i = _mm256_loadu_ps(b_im + j);
+            const __m256 c0r = _mm256_loadu_ps(c_re + j), c0i = _mm256_loadu_ps(c_im + j);
+            const __m256 d0r = _mm256_loadu_ps(d_re + j), d0i = _mm256_loadu_ps(d_im + j);
+
+            __m256 wr = _mm256_loadu_ps(w2_re + j), wi = _mm256_loadu_ps(w2_im + j);
+            const __m256 br = _mm256_fmsub_ps(b0r, wr, _mm256_mul_ps(b0i, wi));
+            const __m256 bi = _mm256_fmadd_ps(b0r, wi, _mm256_mul_ps(b0i, wr));
+            wr = _mm256_loadu_ps(w1_re + j); wi = _mm256_loadu_ps(w1_im + j);
+            const __m256 cr = _mm256_fmsub_ps(c0r, wr, _mm256_mul_ps(c0i, wi));
+            const __m256 ci = _mm256_fmadd_ps(c0r, wi, _mm256_mul_ps(c0i, wr));
+            wr = _mm256_loadu_ps(w3_re + j); wi = _mm256_loadu_ps(w3_im + j);
+            const __m256 dr = _mm256_fmsub_ps(d0r, wr, _mm256_mul_ps(d0i, wi));
+            const __m256 di = _mm256_fmadd_ps(d0r, wi, _mm256_mul_ps(d0i, wr));
+
+            const __m256 t0r = _mm256_add_ps(ar, br), t0i = _mm256_add_ps(ai, bi);
+            const __m256 t1r = _mm256_sub_ps(ar, br), t1i = _mm256_sub_ps(ai, bi);
+            const __m256 t2r = _mm256_add_ps(cr, dr), t2i = _mm256_add_ps(ci, di);
+            const __m256 t3r = _mm256_sub_ps(cr, dr), t3i = _mm256_sub_ps(ci, di);
+
+            _mm256_storeu_ps(a_re + j, _mm256_add_ps(t0r, t2r)); _mm256_storeu_ps(a_im + j, _mm256_add_ps(t0i, t2i));
+            _mm256_storeu_ps(b_re + j, _mm256_add_ps(t1r, t3i)); _mm256_storeu_ps(b_im + j, _mm256_sub_ps(t1i, t3r));
+            _mm256_storeu_ps(c_re + j, _mm256_sub_ps(t0r, t2r)); _mm256_storeu_ps(c_im + j, _mm256_sub_ps(t0i, t2i));
+            _mm256_storeu_ps(d_re + j, _mm256_sub_ps(t1r, t3i)); _mm256_storeu_ps(d_im + j, _mm256_add_ps(t1i, t3r));
+        }
+    }
+}
+#endif
+
+#if defined(__SSE2__)
+void radix4_stage_sse2(float *re, float *im, const size_t count, const size_t quarter, const float *twiddles) {
+    if (quarter < 4) {
+        radix4_stage_scalar(re, im, count, quarter, twiddles);
+        return;
+    }
+    const float *w2_re = twiddles, *w2_im = twiddles + quarter;
+    const float *w1_re = twiddles + 2 * quarter, *w1_im = twiddles + 3 * quarter;
+    const float *w3_re = twiddles + 4 * quarter, *w3_im = twiddles + 5 * quarter;
+
+    for (size_t k = 0; k < count; k += 4 * quarter) {
+        float *a_re = re + k, *b_re = a_re + quarter, *c_re = b_re + quarter, *d_re = c_re + quarter;
+        float *a_im = im + k, *b_im = a_im + quarter, *c_im = b_im + quarter, *d_im = c_im + quarter;
+        for (size_t j = 0; j < quarter; j += 4) {
+            const __m128 ar = _mm_loadu_ps(a_re + j), ai = _mm_loadu_ps(a_im + j);
+            const __m128 b0r = _mm_loadu_ps(b_re + j), b0i = _mm_loadu_ps(b_im + j);
+            const __m128 c0r = _mm_loadu_ps(c_re + j), c0i = _mm_loadu_ps(c_im + j);
+            const __m128 d0r = _mm_loadu_ps(d_re + j), d0i = _mm_loadu_ps(d_im + j);
+
+            __m128 wr = _mm_loadu_ps(w2_re + j), wi = _mm_loadu_ps(w2_im + j);
+            const __m128 br = _mm_sub_ps(_mm_mul_ps(b0r, wr), _mm_mul_ps(b0i, wi));
+            const __m128 bi = _mm_add_ps(_mm_mul_ps(b0r, wi), _mm_mul_ps(b0i, wr));
+            wr = _mm_loadu_ps(w1_re + j); wi = _mm_loadu_ps(w1_im + j);
+            const __m128 cr = _mm_sub_ps(_mm_mul_ps(c0r, wr), _mm_mul_ps(c0i, wi));
+            const __m128 ci = _mm_add_ps(_mm_mul_ps(c0r, wi), _mm_mul_ps(c0i, wr));
+            wr = _mm_loadu_ps(w3_re + j); wi = _mm_loadu_ps(w3_im + j);
+            const __m128 dr = _mm_sub_ps(_mm_mul_ps(d0r, wr), _mm_mul_ps(d0i, wi));
+            const __m128 di = _mm_add_ps(_mm_mul_ps(d0r, wi), _mm_mul_ps(d0i, wr));
+
+            const __m128 t0r = _mm_add_ps(ar, br), t0i = _mm_add_ps(ai, bi);
+            const __m128 t1r = _mm_sub_ps(ar, br), t1i = _mm_sub_ps(ai, bi);
+            const __m128 t2r = _mm_add_ps(cr, dr), t2i = _mm_add_ps(ci, di);
+            const __m128 t3r = _mm_sub_ps(cr, dr), t3i = _mm_sub_ps(ci, di);
+
+            _mm_storeu_ps(a_re + j, _mm_add_ps(t0r, t2r)); _mm_storeu_ps(a_im + j, _mm_add_ps(t0i, t2i));
+            _mm_storeu_ps(b_re + j, _mm_add_ps(t1r, t3i)); _mm_storeu_ps(b_im + j, _mm_sub_ps(t1i, t3r));
+            _mm_storeu_ps(c_re + j, _mm_sub_ps(t0r, t2r)); _mm_storeu_ps(c_im + j, _mm_sub_ps(t0i, t2i));
+            _mm_storeu_ps(d_re + j, _mm_sub_ps(t1r, t3i)); _mm_storeu_ps(d_im + j, _mm_add_ps(t1i, t3r));
+        }
+    }
+}
+#endif
+
+#if defined(__ARM_NEON)
+void radix4_stage_neon(float *re, float *im, const size_t count, const size_t quarter, const float *twiddles) {
+    if (quarter < 4) {
+        radix4_stage_scalar(re, im, count, quarter, twiddles);
+        return;
+    }
+    const float *w2_re = twiddles, *w2_im = twiddles + quarter;
+    const float *w1_re = twiddles + 2 * quarter, *w1_im = twiddles + 3 * quarter;
+    const float *w3_re = twiddles + 4 * quarter, *w3_im = twiddles + 5 * quarter;
+
+    for (size_t k = 0; k < count; k += 4 * quarter) {
+        float *a_re = re + k, *b_re = a_re + quarter, *c_re = b_re + quarter, *d_re = c_re + quarter;
+        float *a_im = im + k, *b_im = a_im + quarter, *c_im = b_im + quarter, *d_im = c_im + quarter;
+        for (size_t j = 0; j < quarter; j += 4) {
+            const float32x4_t ar = vld1q_f32(a_re + j), ai = vld1q_f32(a_im + j);
+            const float32x4_t b0r = vld1q_f32(b_re + j), b0i = vld1q_f32(b_im + j);
+            const float32x4_t c0r = vld1q_f32(c_re + j), c0i = vld1q_f32(c_im + j);
+            const float32x4_t d0r = vld1q_f32(d_re + j), d0i = vld1q_f32(d_im + j);
+
+            float32x4_t wr = vld1q_f32(w2_re + j), wi = vld1q_f32(w2_im + j);
+            const float32x4_t br = vmlsq_f32(vmulq_f32(b0r, wr), b0i, wi);
+            const float32x4_t bi = vmlaq_f32(vmulq_f32(b0r, wi), b0i, wr);
+            wr = vld1q_f32(w1_re + j); wi = vld1q_f32(w1_im + j);
+            const float32x4_t cr = vmlsq_f32(vmulq_f32(c0r, wr), c0i, wi);
+            const float32x4_t ci = vmlaq_f32(vmulq_f32(c0r, wi), c0i, wr);
+            wr = vld1q_f32(w3_re + j); wi = vld1q_f32(w3_im + j);
+            const float32x4_t dr = vmlsq_f32(vmulq_f32(d0r, wr), d0i, wi);
+            const float32x4_t di = vmlaq_f32(vmulq_f32(d0r, wi), d0i, wr);
+
+            const float32x4_t t0r = vaddq_f32(ar, br), t0i = vaddq_f32(ai, bi);
+            const float32x4_t t1r = vsubq_f32(ar, br), t1i = vsubq_f32(ai, bi);
+            const float32x4_t t2r = vaddq_f32(cr, dr), t2i = vaddq_f32(ci, di);
+            const float32x4_t t3r = vsubq_f32(cr, dr), t3i = vsubq_f32(ci, di);
+
+            vst1q_f32(a_re + j, vaddq_f32(t0r, t2r)); vst1q_f32(a_im + j, vaddq_f32(t0i, t2i));
+            vst1q_f32(b_re + j, vaddq_f32(t1r, t3i)); vst1q_f32(b_im + j, vsubq_f32(t1i, t3r));
+            vst1q_f32(c_re + j, vsubq_f32(t0r, t2r)); vst1q_f32(c_im + j, vsubq_f32(t0i, t2i));
+            vst1q_f32(d_re + j, vsubq_f32(t1r, t3i)); vst1q_f32(d_im + j, vaddq_f32(t1i, t3r));
+        }
+    }
+}
+#endif
+
+Radix4SpectrumEngine::Radix4Stage pick_radix4_stage(const char** name) {
+#if defined(__x86_64__) || defined(__i386__)
+    if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma")) {
+        *name = "avx2";
+        return radix4_stage_avx2;
+    }
+#endif
+#if defined(__SSE2__)
+    *name = "sse2";
+    return radix4_stage_sse2;
+#elif defined(__ARM_NEON)
+    *name = "neon";
+    return radix4_stage_neon;
+#else
+    *name = "scalar";
+    return radix4_stage_scalar;
+#endif
+}
+}
+
+Radix4SpectrumEngine::Radix4SpectrumEngine(const size_t size) : SpectrumEngine(size),
+    m_half(size / 2), m_bit_reverse(m_half), m_re(m_half), m_im(m_half), m_unit_window(size, 1.0f)
+{
+    m_radix4_stage = pick_radix4_stage(&m_kernel_name);
+
+    const auto bits = std::countr_zero(m_half);
+    for (size_t n = 0; n < m_half; n++) {
+        uint32_t reversed = 0;
+        for (int b = 0; b < bits; b++) {
+            reversed |= ((n >> b) & 1) << (bits - 1 - b);
+        }
+        m_bit_reverse[n] = reversed;
+    }
+
+    // An odd number of doublings leaves one radix-2 pass, done first so blocks start at 2 points
+    for (size_t quarter = bits % 2 == 0 ? 1 : 2; 4 * quarter <= m_half; quarter *= 4) {
+        m_stages.push_back(Stage { .quarter = quarter, .twiddle_offset = m_twiddles.size() });
+        const double step = -2.0 * M_PI / static_cast<double>(4 * quarter);
+        for (const size_t power : {2, 1, 3}) {
+            const size_t begin = m_twiddles.size();
+            m_twiddles.resize(begin + 2 * quarter);
+            for (size_t j = 0; j < quarter; j++) {
+                const double angle = step * static_cast<double>(power * j);
+                m_twiddles[begin + j] = static_cast<float>(std::cos(angle));
+                m_twiddles[begin + quarter + j] = static_cast<float>(std::sin(angle));
+            }
+        }
+    }
+
+    m_real_twiddle_re.resize(m_half);
+    m_real_twiddle_im.resize(m_half);
+    for (size_t k = 0; k < m_half; k++) {
+        const double angle = -2.0 * M_PI * static_cast<double>(k) / static_cast<double>(size);
+        m_real_twiddle_re[k] = static_cast<float>(std::cos(angle));
+        m_real_twiddle_im[k] = static_cast<float>(std::sin(angle));
+    }
+}
+
+void Radix4SpectrumEngine::transform(const std::span<const float> older, const std::span<const float> newer,
+                                     const std::span<const float> window, const std::span<float> magnitudes) {
+    load(older, newer, window);
+
+    if (std::countr_zero(m_half) % 2 == 1) radix2_pass();
+    for (const auto &stage : m_stages) {
+        m_radix4_stage(m_re.data(), m_im.data(), m_half, stage.quarter, m_twiddles.data() + stage.twiddle_offset);
+    }
+
+    // Z = FFT(x[2n] + i x[2n + 1]) holds the even and odd sample spectra E and O tangled together:
+    // E[k] = (Z[k] + conj Z[-k]) / 2, O[k] = -i (Z[k] - conj Z[-k]) / 2 and X[k] = E[k] + W_N^k O[k]
+    const size_t mask = m_half - 1;
+    for (size_t k = 0; k < m_half; k++) {
+        const size_t mirror = (m_half - k) & mask;
+        const float zr = m_re[k], zi = m_im[k];
+        const float cr = m_re[mirror], ci = -m_im[mirror];
+        const float er = 0.5f * (zr + cr), ei = 0.5f * (zi + ci);
+        const float or_ = 0.5f * (zi - ci), oi = -0.5f * (zr - cr);
+        const float xr = er + m_real_twiddle_re[k] * or_ - m_real_twiddle_im[k] * oi;
+        const float xi = ei + m_real_twiddle_re[k] * oi + m_real_twiddle_im[k] * or_;
+        magnitudes[k] = std::sqrt(xr * xr + xi * xi);
+    }
+}
+
+void Radix4SpectrumEngine::load(const std::span<const float> older, const std::span<const float> newer,
+                                const std::span<const float> window) {
+    if (window.empty()) {
+        load(older, newer, m_unit_window);
+        return;
+    }
+
+    // Pair n is samples 2n and 2n + 1; the split between the spans can fall inside a pair
+    const size_t split = older.size();
+    size_t n = 0;
+    for (; 2 * n + 1 < split; n++) {
+        m_re[m_bit_reverse[n]] = older[2 * n] * window[2 * n];
+        m_im[m_bit_reverse[n]] = older[2 * n + 1] * window[2 * n + 1];
+    }
+    if (split % 2 == 1) {
+        m_re[m_bit_reverse[n]] = older[split - 1] * window[split - 1];
+        m_im[m_bit_reverse[n]] = newer[0] * window[split];
+        n++;
+    }
+    for (; n < m_half; n++) {
+        m_re[m_bit_reverse[n]] = newer[2 * n - split] * window[2 * n];
+        m_im[m_bit_reverse[n]] = newer[2 * n + 1 - split] * window[2 * n + 1];
+    }
+}
+
+void Radix4SpectrumEngine::radix2_pass() {
+    for (size_t k = 0; k < m_half; k += 2) {
+        const float ar = m_re[k], ai = m_im[k];
+        m_re[k] = ar + m_re[k + 1];
+        m_im[k] = ai + m_im[k + 1];
+        m_re[k + 1] = ar - m_re[k + 1];
+        m_im[k + 1] = ai - m_im[k + 1];
+    }
+}
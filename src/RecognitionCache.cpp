@@ -0,0 +1,289 @@
+//
+// Created by Sebastian Sandstig on 2026-10-17.
+//
+
+#include <RecognitionCache.h>
+
+#include <algorithm>
+#include <array>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <iostream>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// File layout, native byte order since the file never leaves the machine:
+//   "SSRECOG1"
+//   per record: u32 body size, u32 FNV-1a of the body, body = u64 track id hash followed by key, title, subtitle,
+//   cover art and joecolor, each a u32 length and its bytes.
+// A record cut short by a crash mid-append fails its size or checksum and is truncated away on the next open.
+namespace {
+    constexpr std::array<char, 8> MAGIC = {'S', 'S', 'R', 'E', 'C', 'O', 'G', '1'};
+    constexpr size_t RECORD_HEADER_SIZE = 2 * sizeof(uint32_t);
+
+    uint64_t fnv1a64(const std::string_view text, uint64_t hash = 14695981039346656037ull) {
+        for (const char c : text) {
+            hash ^= static_cast<unsigned char>(c);
+            hash *= 1099511628211ull;
+        }
+        return hash;
+    }
+
+    uint32_t fnv1a32(const char *data, const size_t size) {
+        uint32_t hash = 2166136261u;
+        for (size_t i = 0; i < size; i++) {
+            hash ^= static_cast<unsigned char>(data[i]);
+            hash *= 16777619u;
+        }
+        return hash;
+    }
+
+    // Fingerprints and track ids share the LRU, so they hash in separate domains
+    uint64_t fingerprint_hash(const std::string &signature) { return fnv1a64(signature, fnv1a64("fingerprint:")); }
+    uint64_t track_hash(const std::string &key) { return fnv1a64(key, fnv1a64("track:")); }
+
+    template<typename T>
+    void put(std::string &out, const T value) {
+        out.append(reinterpret_cast<const char *>(&value), sizeof(value));
+    }
+    void put(std::string &out, const std::string &text) {
+        put(out, static_cast<uint32_t>(text.size()));
+        out += text;
+    }
+
+    // Bounds-checked reads out of the mapping
+    class Cursor {
+    public:
+        Cursor(const char *data, const size_t size) : m_data(data), m_size(size) {}
+
+        template<typename T>
+        bool get(T &value) {
+            if (m_size - m_used < sizeof(T)) return false;
+            std::memcpy(&value, m_data + m_used, sizeof(T));
+            m_used += sizeof(T);
+            return true;
+        }
+        bool get(std::string &text) {
+            uint32_t size = 0;
+            if (!get(size) || m_size - m_used < size) return false;
+            text.assign(m_data + m_used, size);
+            m_used += size;
+            return true;
+        }
+    private:
+        const char *m_data;
+        size_t m_size;
+        size_t m_used = 0;
+    };
+}
+
+RecognitionCache::RecognitionCache(const size_t capacity, const std::string &path)
+    : m_capacity(std::max<size_t>(capacity, 1)), m_path(path)
+{
+    if (!m_path.empty()) open_file();
+}
+
+RecognitionCache::~RecognitionCache() {
+    if (m_map != nullptr) munmap(const_cast<char *>(m_map), m_mapped_size);
+    if (m_fd >= 0) close(m_fd);
+}
+
+std::optional<RecognizedTrack> RecognitionCache::find_fingerprint(const std::string &signature) {
+    std::lock_guard<std::mutex> guard(m_mutex);
+    return find(fingerprint_hash(signature));
+}
+
+std::optional<RecognizedTrack> RecognitionCache::find_track(const std::string &key) {
+    std::lock_guard<std::mutex> guard(m_mutex);
+    return find(track_hash(key));
+}
+
+void RecognitionCache::insert(const std::string &signature, const RecognizedTrack &track) {
+    std::lock_guard<std::mutex> guard(m_mutex);
+    const auto shared = std::make_shared<const RecognizedTrack>(track);
+    remember(fingerprint_hash(signature), shared);
+    if (track.key.empty()) return;
+    const uint64_t hash = track_hash(track.key);
+    remember(hash, shared);
+
+    if (m_fd < 0) return;
+    if (const auto stored = m_records.find(hash); stored != m_records.end()) {
+        if (m_mapped_size < m_file_size) remap();
+        if (read_record(stored->second, hash) == track) return;
+    }
+    append(hash, track);
+}
+
+RecognitionCache::Counters RecognitionCache::counters() const {
+    std::lock_guard<std::mutex> guard(m_mutex);
+    Counters counters = m_counters;
+    counters.stored_tracks = m_records.size();
+    return counters;
+}
+
+void RecognitionCache::print(std::ostream &out) const {
+    const auto counters = this->counters();
+    std::lock_guard<std::mutex> guard(m_mutex);
+    out << "recognition cache: " << counters.hits << " hits, " << counters.disk_hits << " from disk, "
+        << counters.misses << " misses, " << counters.evictions << " evictions, " << counters.stored_tracks
+        << " tracks in " << (m_fd >= 0 ? m_path : std::string("memory only")) << std::endl;
+}
+
+std::string RecognitionCache::default_path() {
+    if (const char *xdg = std::getenv("XDG_CACHE_HOME"); xdg != nullptr && *xdg != '\0') {
+        return (std::filesystem::path(xdg) / "soundscape" / "recognitions").string();
+    }
+    if (const char *home = std::getenv("HOME"); home != nullptr && *home != '\0') {
+        return (std::filesystem::path(home) / ".cache" / "soundscape" / "recognitions").string();
+    }
+    return "";
+}
+
+std::optional<RecognizedTrack> RecognitionCache::find(const uint64_t hash) {
+    if (const auto entry = m_entries.find(hash); entry != m_entries.end()) {
+        m_lru.splice(m_lru.begin(), m_lru, entry->second);
+        m_counters.hits++;
+        return *entry->second->second;
+    }
+    if (const auto stored = m_records.find(hash); stored != m_records.end()) {
+        // Appended since the last mapping
+        if (m_fd >= 0 && m_mapped_size < m_file_size) remap();
+        if (auto track = read_record(stored->second, hash)) {
+            remember(hash, std::make_shared<const RecognizedTrack>(*track));
+            m_counters.disk_hits++;
+            return track;
+        }
+        // Not what the file holds there after all; forget it so the next insert appends it again
+        m_records.erase(stored);
+    }
+    m_counters.misses++;
+    return std::nullopt;
+}
+
+void RecognitionCache::remember(const uint64_t hash, const std::shared_ptr<const RecognizedTrack> &track) {
+    if (const auto entry = m_entries.find(hash); entry != m_entries.end()) {
+        entry->second->second = track;
+        m_lru.splice(m_lru.begin(), m_lru, entry->second);
+        return;
+    }
+    m_lru.emplace_front(hash, track);
+    m_entries[hash] = m_lru.begin();
+    while (m_lru.size() > m_capacity) {
+        m_entries.erase(m_lru.back().first);
+        m_lru.pop_back();
+        m_counters.evictions++;
+    }
+}
+
+void RecognitionCache::open_file() {
+    const auto fail = [this](const std::string &what) {
+        std::cerr << "Recognition cache " << m_path << ": " << what << ", keeping results in memory only" << std::endl;
+        if (m_fd >= 0) close(m_fd);
+        m_fd = -1;
+    };
+
+    std::error_code error;
+    std::filesystem::create_directories(std::filesystem::path(m_path).parent_path(), error);
+    m_fd = open(m_path.c_str(), O_RDWR | O_CREAT | O_APPEND | O_CLOEXEC, 0644);
+    if (m_fd < 0) return fail(std::strerror(errno));
+    struct stat status {};
+    if (fstat(m_fd, &status) != 0) return fail(std::strerror(errno));
+    m_file_size = static_cast<size_t>(status.st_size);
+
+    if (m_file_size == 0) {
+        if (write(m_fd, MAGIC.data(), MAGIC.size()) != static_cast<ssize_t>(MAGIC.size())) {
+            return fail(std::strerror(errno));
+        }
+        m_file_size = MAGIC.size();
+    }
+    if (!remap()) return fail(std::strerror(errno));
+    if (m_mapped_size < MAGIC.size() || std::memcmp(m_map, MAGIC.data(), MAGIC.size()) != 0) {
+        return fail("not a recognition cache");
+    }
+
+    size_t offset = MAGIC.size();
+    while (offset < m_file_size) {
+        uint32_t body_size = 0, checksum = 0;
+        Cursor header(m_map + offset, m_file_size - offset);
+        uint64_t hash = 0;
+        if (!header.get(body_size) || !header.get(checksum) ||
+            m_file_size - offset - RECORD_HEADER_SIZE < body_size || body_size < sizeof(hash) ||
+            fnv1a32(m_map + offset + RECORD_HEADER_SIZE, body_size) != checksum) {
+            break;
+        }
+        std::memcpy(&hash, m_map + offset + RECORD_HEADER_SIZE, sizeof(hash));
+        m_records[hash] = offset;       // A newer record of the same track replaces the older one
+        offset += RECORD_HEADER_SIZE + body_size;
+    }
+    if (offset < m_file_size) {
+        std::cerr << "Recognition cache " << m_path << ": dropping " << m_file_size - offset
+                  << " bytes of an incomplete record" << std::endl;
+        if (ftruncate(m_fd, static_cast<off_t>(offset)) != 0) return fail(std::strerror(errno));
+        m_file_size = offset;
+    }
+}
+
+bool RecognitionCache::remap() {
+    if (m_map != nullptr) munmap(const_cast<char *>(m_map), m_mapped_size);
+    m_map = nullptr;
+    m_mapped_size = 0;
+    void *map = mmap(nullptr, m_file_size, PROT_READ, MAP_SHARED, m_fd, 0);
+    if (map == MAP_FAILED) return false;
+    m_map = static_cast<const char *>(map);
+    m_mapped_size = m_file_size;
+    return true;
+}
+
+void RecognitionCache::append(const uint64_t hash, const RecognizedTrack &track) {
+    std::string body;
+    put(body, hash);
+    for (const std::string *field : {&track.key, &track.title, &track.subtitle, &track.cover_art, &track.joe_color}) {
+        put(body, *field);
+    }
+    std::string record;
+    put(record, static_cast<uint32_t>(body.size()));
+    put(record, fnv1a32(body.data(), body.size()));
+    record += body;
+
+    // One write, so a concurrent reader of the file never sees half a record from us; a crash might leave one.
+    // Another instance may have appended to the same file since we last looked, so where the record landed comes
+    // from the file position O_APPEND left behind, not from our own idea of the file's size.
+    off_t end = -1;
+    if (write(m_fd, record.data(), record.size()) != static_cast<ssize_t>(record.size()) ||
+        (end = lseek(m_fd, 0, SEEK_CUR)) < static_cast<off_t>(record.size())) {
+        std::cerr << "Recognition cache " << m_path << ": " << std::strerror(errno)
+                  << ", keeping results in memory only" << std::endl;
+        close(m_fd);
+        m_fd = -1;
+        return;
+    }
+    m_file_size = static_cast<size_t>(end);
+    m_records[hash] = m_file_size - record.size();
+}
+
+std::optional<RecognizedTrack> RecognitionCache::read_record(const size_t offset, const uint64_t expected_hash) const {
+    // The offset came from this process's view of a file other instances append to as well, so the record there
+    // has to prove it is intact and the one asked for
+    if (offset >= m_mapped_size) return std::nullopt;
+    Cursor header(m_map + offset, m_mapped_size - offset);
+    uint32_t body_size = 0, checksum = 0;
+    if (!header.get(body_size) || !header.get(checksum) || m_mapped_size - offset - RECORD_HEADER_SIZE < body_size) {
+        return std::nullopt;
+    }
+    const char *body = m_map + offset + RECORD_HEADER_SIZE;
+    if (fnv1a32(body, body_size) != checksum) return std::nullopt;
+
+    Cursor cursor(body, body_size);
+    uint64_t hash = 0;
+    RecognizedTrack track;
+    if (!cursor.get(hash) || hash != expected_hash || !cursor.get(track.key) || !cursor.get(track.title) ||
+        !cursor.get(track.subtitle) || !cursor.get(track.cover_art) || !cursor.get(track.joe_color)) {
+        return std::nullopt;
+    }
+    return track;
+}
\ No newline at end of file
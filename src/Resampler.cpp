@@ -0,0 +1,92 @@
+//
+// Created by Sebastian Sandstig on 2026-10-17.
+//
+
+#include <Resampler.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <numeric>
+
+Resampler::Resampler(const size_t input_rate, const size_t output_rate, const size_t taps_per_phase) :
+    m_input_rate(input_rate), m_output_rate(output_rate)
+{
+    const auto divisor = std::gcd(input_rate, output_rate);
+    m_up = output_rate / divisor;
+    m_down = input_rate / divisor;
+    m_taps = m_up == m_down ? 1 : taps_per_phase;
+
+    design_filter();
+    reset();
+}
+
+size_t Resampler::max_output(const size_t input_count) const {
+    return (input_count * m_up) / m_down + 1;
+}
+
+size_t Resampler::process(const float *in, const size_t count, float *out) {
+    if (m_up == m_down) {
+        std::memcpy(out, in, count * sizeof(float));
+        return count;
+    }
+
+    const size_t history = m_taps - 1;
+    if (m_work.size() < history + count) m_work.resize(history + count);
+    std::memcpy(m_work.data() + history, in, count * sizeof(float));
+
+    size_t produced = 0;
+    for (size_t base = m_next / m_up; base < count; base = m_next / m_up) {
+        const float *x = m_work.data() + base;  // x[history] is input sample `base`
+        const float *h = m_coefficients.data() + (m_next % m_up) * m_taps;
+        float y = 0.0f;
+        for (size_t k = 0; k < m_taps; k++) {
+            y += h[k] * x[k];
+        }
+        out[produced++] = y;
+        m_next += m_down;
+    }
+    m_next -= count * m_up;
+
+    // Carry the tail over as history for the next block
+    std::memmove(m_work.data(), m_work.data() + count, history * sizeof(float));
+
+    return produced;
+}
+
+void Resampler::reset() {
+    m_work.assign(m_taps - 1, 0.0f);
+    m_next = 0;
+}
+
+void Resampler::design_filter() {
+    if (m_up == m_down) {
+        m_coefficients = { 1.0f };
+        return;
+    }
+
+    // Prototype low-pass at the upsampled rate, cut off just below the lower of the two Nyquist frequencies
+    const size_t length = m_up * m_taps;
+    const double cutoff = 0.45 * static_cast<double>(std::min(m_input_rate, m_output_rate)) /
+                          static_cast<double>(m_input_rate * m_up);
+    const double centre = static_cast<double>(length - 1) / 2.0;
+    std::vector<double> prototype(length);
+    double sum = 0.0;
+    for (size_t n = 0; n < length; n++) {
+        const double t = static_cast<double>(n) - centre;
+        const double sinc = t == 0.0 ? 2.0 * cutoff : std::sin(2.0 * M_PI * cutoff * t) / (M_PI * t);
+        const double phase = 2.0 * M_PI * static_cast<double>(n) / static_cast<double>(length - 1);
+        const double blackman = 0.42 - 0.5 * std::cos(phase) + 0.08 * std::cos(2.0 * phase);
+        prototype[n] = sinc * blackman;
+        sum += prototype[n];
+    }
+
+    // Split into phases; the gain of L makes up for the zeros the upsampler would have stuffed in
+    m_coefficients.resize(length);
+    const double gain = static_cast<double>(m_up) / sum;
+    for (size_t phase = 0; phase < m_up; phase++) {
+        for (size_t k = 0; k < m_taps; k++) {
+            m_coefficients[phase * m_taps + (m_taps - 1 - k)] = static_cast<float>(prototype[k * m_up + phase] * gain);
+        }
+    }
+}
@@ -0,0 +1,48 @@
+//
+// Created by Sebastian Sandstig on 2026-10-17.
+//
+
+#include <SpectrumAnalyzer.h>
+
+namespace {
+    template<size_t N, size_t Bars, size_t SampleRate, size_t LowHz, size_t HighHz>
+    SpectrumAnalyzerRegistry::Entry entry() {
+        return SpectrumAnalyzerRegistry::Entry {
+            .fft_size = N,
+            .bar_count = Bars,
+            .sample_rate = SampleRate,
+            .low_frequency = LowHz,
+            .high_frequency = HighHz,
+            .create = [] () -> std::unique_ptr<StaticAnalyzer> {
+                return std::make_unique<SpectrumAnalyzer<N, Bars, SampleRate, LowHz, HighHz>>();
+            },
+        };
+    }
+
+    // The deployed configurations. Each one costs its tables in read-only data and a little compile time.
+    const SpectrumAnalyzerRegistry::Entry ENTRIES[] = {
+        entry<8192, 16, 24000, 30, 10000>(),    // Live display defaults, see AudioRecordSettings
+        entry<4096, 64, 24000, 30, 10000>(),
+        entry<8192, 16, 44100, 30, 10000>(),    // Offline spectrograms of CD-rate files at their own rate
+        entry<8192, 16, 48000, 30, 10000>(),
+    };
+}
+
+std::unique_ptr<StaticAnalyzer> SpectrumAnalyzerRegistry::create(const size_t fft_size, const size_t bar_count,
+                                                                  const size_t sample_rate, const float low_frequency,
+                                                                  const float high_frequency)
+{
+    for (const auto &candidate : ENTRIES) {
+        if (candidate.fft_size == fft_size && candidate.bar_count == bar_count &&
+            candidate.sample_rate == sample_rate &&
+            static_cast<float>(candidate.low_frequency) == low_frequency &&
+            static_cast<float>(candidate.high_frequency) == high_frequency) {
+            return candidate.create();
+        }
+    }
+    return nullptr;
+}
+
+std::span<const SpectrumAnalyzerRegistry::Entry> SpectrumAnalyzerRegistry::entries() {
+    return ENTRIES;
+}
@@ -0,0 +1,118 @@
+//
+// Created by Sebastian Sandstig on 2026-10-17.
+//
+
+#include <SpectrumEngine.h>
+
+#include <bit>
+#include <cmath>
+#include <stdexcept>
+
+#define GLM_FORCE_RADIANS
+#define GLM_FORCE_DEPTH_ZERO_TO_ONE
+#include <glm/exponential.hpp>
+#include <glm/geometric.hpp>
+#include <glm/trigonometric.hpp>
+#include <glm/vec2.hpp>
+
+#include <Radix4SpectrumEngine.h>
+#ifdef SOUNDSCAPE_WITH_FFTW
+#include <FftwSpectrumEngine.h>
+#endif
+
+std::unique_ptr<SpectrumEngine> SpectrumEngine::create(const Kind kind, const size_t size) {
+    if (!std::has_single_bit(size)) {
+        throw std::runtime_error("SpectrumEngine: size must be a power of two");
+    }
+
+    switch (kind) {
+        case RADIX2:
+            return std::make_unique<Radix2SpectrumEngine>(size);
+        case RADIX4:
+            return std::make_unique<Radix4SpectrumEngine>(size);
+        case FFTW:
+#ifdef SOUNDSCAPE_WITH_FFTW
+            return std::make_unique<FftwSpectrumEngine>(size);
+#else
+            throw std::runtime_error("SpectrumEngine: built without FFTW");
+#endif
+    }
+    throw std::runtime_error("Unknown spectrum engine kind");
+}
+
+const char* SpectrumEngine::kind_name(const Kind kind) {
+    switch (kind) {
+        case RADIX2:
+            return "radix2";
+        case RADIX4:
+            return "radix4";
+        case FFTW:
+            return "fftw";
+    }
+    return "unknown";
+}
+
+std::optional<SpectrumEngine::Kind> SpectrumEngine::parse_kind(const std::string &name) {
+    for (const auto kind : {RADIX2, RADIX4, FFTW}) {
+        if (name == kind_name(kind)) return kind;
+    }
+    return std::nullopt;
+}
+
+Radix2SpectrumEngine::Radix2SpectrumEngine(const size_t size) : SpectrumEngine(size),
+    m_log2_size(std::countr_zero(size)), m_dft_real(size), m_dft_imag(size) {}
+
+void Radix2SpectrumEngine::transform(const std::span<const float> older, const std::span<const float> newer,
+                                     const std::span<const float> window, const std::span<float> magnitudes) {
+    load_bit_reversed(older, 0, window);
+    load_bit_reversed(newer, older.size(), window);
+
+    const auto magnitude = m_log2_size;
+    const auto n = size();
+
+    for (size_t s = 1; s < magnitude + 1; s++) {
+        const auto float_s = static_cast<double>(s);
+        const double m = glm::pow(2, float_s);
+        // Double precision: the twiddle recurrence below runs up to n / 2 steps and float drifts visibly by 64k
+        const auto w_m = glm::dvec2(glm::cos(- 2 * M_PI / m), glm::sin(- 2 * M_PI / m));
+
+        for (size_t k = 0; k < n; k += static_cast<size_t>(m)) {
+            auto w = glm::dvec2(1, 0);
+            const auto m_by_2 = static_cast<size_t>(m / 2);
+            for (size_t j = 0; j < m_by_2; j++) {
+                const size_t t_index = k + j + m_by_2;
+                const auto t = glm::vec2(w.r * m_dft_real[t_index] - w.g * m_dft_imag[t_index],
+                                         w.r * m_dft_imag[t_index] + w.g * m_dft_real[t_index]);
+                const size_t u_index = k + j;
+                const auto u = glm::vec2(m_dft_real[u_index], m_dft_imag[u_index]);
+
+                m_dft_real[u_index] = u.r + t.r;
+                m_dft_imag[u_index] = u.g + t.g;
+                m_dft_real[t_index] = u.r - t.r;
+                m_dft_imag[t_index] = u.g - t.g;
+
+                // Complex multiply w *= w_m; both parts must come from the old w
+                w = glm::dvec2(w.r * w_m.r - w.g * w_m.g, w.r * w_m.g + w.g * w_m.r);
+            }
+        }
+    }
+
+    for (size_t i = 0; i < bin_count(); i++) {
+        magnitudes[i] = glm::length(glm::vec2(m_dft_real[i], m_dft_imag[i]));
+    }
+}
+
+void Radix2SpectrumEngine::load_bit_reversed(const std::span<const float> samples, const size_t offset,
+                                             const std::span<const float> window) {
+    for (size_t i = 0; i < samples.size(); i++) {
+        const size_t k = offset + i;
+        size_t rev_k = 0;
+        for (size_t b = 0; b < m_log2_size; b++) {
+            rev_k <<= 1;
+            if (k & (1 << b)) rev_k |= 1;
+        }
+
+        m_dft_real[rev_k] = window.empty() ? samples[i] : samples[i] * window[k];
+        m_dft_imag[rev_k] = 0;
+    }
+}
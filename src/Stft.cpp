@@ -0,0 +1,80 @@
+//
+// Created by Sebastian Sandstig on 2026-10-17.
+//
+
+#include <Stft.h>
+
+#include <cmath>
+#include <numeric>
+#include <stdexcept>
+
+Stft::Stft(const CaptureRing &ring, const size_t fft_size, const size_t hop_size, const Window window,
+           const SpectrumEngine::Kind engine) : m_ring(&ring), m_hop_size(hop_size), m_window_kind(window),
+    m_engine(SpectrumEngine::create(engine, fft_size)), m_magnitudes(m_engine->bin_count())
+{
+    if (hop_size == 0 || hop_size > fft_size) {
+        throw std::runtime_error("Stft: hop_size must be in [1, fft_size]");
+    }
+    if (fft_size > ring.capacity()) {
+        throw std::runtime_error("Stft: ring is smaller than one frame");
+    }
+
+    const auto unscaled = make_window(window, fft_size);
+    m_window_sum = std::accumulate(unscaled.begin(), unscaled.end(), 0.0f);
+    m_window = make_scaled_window(window, fft_size);
+
+    // Start on the first hop boundary after whatever is already in the ring
+    m_next_frame_end = (ring.write_cursor() / m_hop_size + 1) * m_hop_size;
+}
+
+bool Stft::update() {
+    for (;;) {
+        const uint64_t write = m_ring->write_cursor();
+        if (write < m_next_frame_end) return false;
+
+        const uint64_t end = write - (write - m_next_frame_end) % m_hop_size;
+        const auto frame = m_ring->snapshot(end, fft_size());
+        m_engine->transform(frame.older, frame.newer, m_window, m_magnitudes);
+        if (!m_ring->valid(frame)) {
+            // The producer lapped the frame while we were reading it, the next hop is already there
+            continue;
+        }
+
+        m_skipped_hops += (end - m_next_frame_end) / m_hop_size;
+        m_frame_end = end;
+        m_next_frame_end = end + m_hop_size;
+        m_frame_count++;
+        return true;
+    }
+}
+
+std::vector<float> Stft::make_scaled_window(const Window window, const size_t size) {
+    auto coefficients = make_window(window, size);
+    const float scale = 2.0f / std::accumulate(coefficients.begin(), coefficients.end(), 0.0f);
+    for (auto &coefficient : coefficients) {
+        coefficient *= scale;
+    }
+    return coefficients;
+}
+
+std::vector<float> Stft::make_window(const Window window, const size_t size) {
+    std::vector<float> coefficients(size, 1.0f);
+    // Periodic (DFT-even) forms, which overlap-add cleanly at the usual hop sizes
+    const double step = 2.0 * M_PI / static_cast<double>(size);
+    for (size_t n = 0; n < size; n++) {
+        const double phase = step * static_cast<double>(n);
+        switch (window) {
+            case RECTANGULAR:
+                break;
+            case HANN:
+                coefficients[n] = static_cast<float>(0.5 - 0.5 * std::cos(phase));
+                break;
+            case BLACKMAN_HARRIS:
+                coefficients[n] = static_cast<float>(0.35875 - 0.48829 * std::cos(phase) +
+                                                     0.14128 * std::cos(2.0 * phase) -
+                                                     0.01168 * std::cos(3.0 * phase));
+                break;
+        }
+    }
+    return coefficients;
+}
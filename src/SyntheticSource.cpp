@@ -0,0 +1,150 @@
+//
+// Created by Sebastian Sandstig on 2026-10-17.
+//
+
+#include <SyntheticSource.h>
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+SyntheticSource::SyntheticSource(const size_t sample_rate, std::vector<SyntheticSignal> signals, const double speed,
+                                 const uint64_t sample_limit) : BlockSource(speed), m_sample_rate(sample_rate),
+    m_signals(std::move(signals)), m_sample_limit(sample_limit)
+{
+    if (m_sample_rate == 0) {
+        throw std::runtime_error("SyntheticSource: sample_rate must not be 0");
+    }
+    for (size_t i = 0; i < m_signals.size(); i++) {
+        const auto &signal = m_signals[i];
+        if (signal.kind == SyntheticSignal::SWEEP && (signal.length == 0 || signal.frequency <= 0.0f ||
+                                                      signal.end_frequency <= 0.0f)) {
+            throw std::runtime_error("SyntheticSource: a sweep needs a length and positive frequencies");
+        }
+        // Distinct, fixed seeds: two noise components are uncorrelated and every run is identical
+        m_pink.push_back(PinkState {.seed = 0x9E3779B9u * static_cast<uint32_t>(i + 1)});
+    }
+}
+
+SyntheticSource::~SyntheticSource() {
+    stop();
+}
+
+void SyntheticSource::generate(float *samples, const size_t count) {
+    for (size_t i = 0; i < count; i++) {
+        float value = 0.0f;
+        for (size_t component = 0; component < m_signals.size(); component++) {
+            value += sample(component, m_generated + i);
+        }
+        samples[i] = value;
+    }
+    m_generated += count;
+}
+
+std::vector<SyntheticSignal> SyntheticSource::parse(const std::string &spec, const size_t sample_rate) {
+    const auto number = [&spec](const std::string &text) {
+        try {
+            size_t used = 0;
+            const float value = std::stof(text, &used);
+            if (used == text.size()) return value;
+        } catch (const std::exception&) {}
+        throw std::runtime_error("SyntheticSource: bad number '" + text + "' in '" + spec + "'");
+    };
+    const auto samples = [sample_rate](const float seconds) {
+        return static_cast<uint64_t>(std::llround(static_cast<double>(seconds) * static_cast<double>(sample_rate)));
+    };
+
+    std::vector<SyntheticSignal> signals;
+    size_t begin = 0;
+    while (begin <= spec.size()) {
+        const size_t end = std::min(spec.find('+', begin), spec.size());
+        std::string component = spec.substr(begin, end - begin);
+        begin = end + 1;
+
+        SyntheticSignal signal;
+        if (const size_t star = component.find('*'); star != std::string::npos) {
+            signal.amplitude = number(component.substr(star + 1));
+            component.resize(star);
+        }
+        const size_t equals = component.find('=');
+        const std::string kind = component.substr(0, equals);
+        const std::string value = equals == std::string::npos ? "" : component.substr(equals + 1);
+
+        if (kind == "sine" && !value.empty()) {
+            signal.kind = SyntheticSignal::SINE;
+            signal.frequency = number(value);
+        } else if (kind == "sweep" && value.find('-') != std::string::npos && value.find('/') != std::string::npos) {
+            const size_t dash = value.find('-'), slash = value.find('/');
+            signal.kind = SyntheticSignal::SWEEP;
+            signal.frequency = number(value.substr(0, dash));
+            signal.end_frequency = number(value.substr(dash + 1, slash - dash - 1));
+            signal.length = samples(number(value.substr(slash + 1)));
+        } else if (kind == "click" && !value.empty()) {
+            signal.kind = SyntheticSignal::CLICK;
+            signal.period = samples(number(value));
+        } else if (kind == "pink" && value.empty()) {
+            signal.kind = SyntheticSignal::PINK_NOISE;
+        } else {
+            throw std::runtime_error("SyntheticSource: cannot parse '" + component + "' in '" + spec + "'");
+        }
+        signals.push_back(signal);
+    }
+    return signals;
+}
+
+size_t SyntheticSource::produce(float *samples, size_t count) {
+    if (m_sample_limit != 0) {
+        if (m_generated >= m_sample_limit) return 0;
+        count = static_cast<size_t>(std::min<uint64_t>(count, m_sample_limit - m_generated));
+    }
+    generate(samples, count);
+    return count;
+}
+
+float SyntheticSource::sample(const size_t component, const uint64_t position) {
+    const auto &signal = m_signals[component];
+    if (position < signal.start) return 0.0f;
+    const uint64_t offset = position - signal.start;
+    if (signal.length != 0 && offset >= signal.length) return 0.0f;
+
+    const double rate = static_cast<double>(m_sample_rate);
+    switch (signal.kind) {
+        case SyntheticSignal::SINE: {
+            // Phase from the absolute offset rather than accumulated, so it never drifts
+            double cycles = static_cast<double>(signal.frequency) * static_cast<double>(offset) / rate;
+            cycles -= std::floor(cycles);
+            return signal.amplitude * static_cast<float>(std::sin(2.0 * M_PI * cycles));
+        }
+        case SyntheticSignal::SWEEP: {
+            const double t = static_cast<double>(offset) / rate;
+            const double duration = static_cast<double>(signal.length) / rate;
+            const double f0 = signal.frequency;
+            const double k = std::log(static_cast<double>(signal.end_frequency) / f0);
+            double cycles = std::abs(k) < 1e-9 ? f0 * t : f0 * duration / k * (std::exp(t * k / duration) - 1.0);
+            cycles -= std::floor(cycles);
+            return signal.amplitude * static_cast<float>(std::sin(2.0 * M_PI * cycles));
+        }
+        case SyntheticSignal::CLICK:
+            if (signal.period == 0) return offset == 0 ? signal.amplitude : 0.0f;
+            return offset % signal.period == 0 ? signal.amplitude : 0.0f;
+        case SyntheticSignal::PINK_NOISE: {
+            auto &state = m_pink[component];
+            state.seed ^= state.seed << 13;
+            state.seed ^= state.seed >> 17;
+            state.seed ^= state.seed << 5;
+            const float white = static_cast<float>(state.seed) / 2147483648.0f - 1.0f;
+            auto &b = state.b;
+            b[0] = 0.99886f * b[0] + white * 0.0555179f;
+            b[1] = 0.99332f * b[1] + white * 0.0750759f;
+            b[2] = 0.96900f * b[2] + white * 0.1538520f;
+            b[3] = 0.86650f * b[3] + white * 0.3104856f;
+            b[4] = 0.55000f * b[4] + white * 0.5329522f;
+            b[5] = -0.7616f * b[5] - white * 0.0168980f;
+            const float pink = b[0] + b[1] + b[2] + b[3] + b[4] + b[5] + b[6] + white * 0.5362f;
+            b[6] = white * 0.115926f;
+            // Brings the filter's gain of about 9 back to roughly unit peaks
+            return signal.amplitude * pink * 0.11f;
+        }
+    }
+    return 0.0f;
+}
\ No newline at end of file
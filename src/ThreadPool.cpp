@@ -0,0 +1,67 @@
+//
+// Created by Sebastian Sandstig on 2026-10-17.
+//
+
+#include <ThreadPool.h>
+
+#include <algorithm>
+
+ThreadPool::ThreadPool(size_t thread_count) {
+    if (thread_count == 0) thread_count = std::max(std::thread::hardware_concurrency(), 1u);
+    m_workers.reserve(thread_count);
+    for (size_t worker = 0; worker < thread_count; worker++) {
+        m_workers.emplace_back(&ThreadPool::work, this, worker);
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> guard(m_mutex);
+        m_stop = true;
+    }
+    m_work_ready.notify_all();
+    for (auto &worker : m_workers) {
+        worker.join();
+    }
+}
+
+void ThreadPool::parallel_for(const size_t count, const std::function<void(size_t index, size_t worker)> &task) {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_task = &task;
+    m_count = count;
+    m_next = 0;
+    m_running = m_workers.size();
+    m_error = nullptr;
+    m_generation++;
+    m_work_ready.notify_all();
+
+    m_work_done.wait(lock, [this] { return m_running == 0; });
+    m_task = nullptr;
+    if (m_error) std::rethrow_exception(m_error);
+}
+
+void ThreadPool::work(const size_t worker) {
+    uint64_t seen = 0;
+    std::unique_lock<std::mutex> lock(m_mutex);
+    for (;;) {
+        m_work_ready.wait(lock, [&] { return m_stop || m_generation != seen; });
+        if (m_stop) return;
+        seen = m_generation;
+
+        while (m_next < m_count) {
+            const size_t index = m_next++;
+            lock.unlock();
+            try {
+                (*m_task)(index, worker);
+            } catch (...) {
+                lock.lock();
+                if (!m_error) m_error = std::current_exception();
+                m_next = m_count;
+                continue;
+            }
+            lock.lock();
+        }
+
+        if (--m_running == 0) m_work_done.notify_one();
+    }
+}
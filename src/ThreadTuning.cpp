@@ -0,0 +1,209 @@
+//
+// Created by Sebastian Sandstig on 2026-10-17.
+//
+
+#include <ThreadTuning.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <mutex>
+#include <stdexcept>
+
+#include <pthread.h>
+#include <sys/mman.h>
+#include <sys/resource.h>
+
+namespace {
+    std::mutex report_mutex;
+    std::vector<std::pair<std::string, std::string>> report_lines;
+    std::vector<ThreadTuning::Deferred *> deferred_tunings;        // Under report_mutex
+
+    // A restarted thread replaces its earlier line. With report_mutex held.
+    void add_line(const std::string &subject, const std::string &outcome) {
+        const auto line = std::ranges::find(report_lines, subject, &std::pair<std::string, std::string>::first);
+        if (line != report_lines.end()) line->second = outcome;
+        else report_lines.emplace_back(subject, outcome);
+    }
+
+    void report(const std::string &subject, const std::string &outcome) {
+        std::lock_guard<std::mutex> guard(report_mutex);
+        add_line(subject, outcome);
+    }
+
+    // "0-3,6"
+    std::string cpu_list(const std::vector<int> &cpus) {
+        std::string list;
+        for (size_t i = 0; i < cpus.size(); i++) {
+            size_t last = i;
+            while (last + 1 < cpus.size() && cpus[last + 1] == cpus[last] + 1) last++;
+            if (!list.empty()) list += ",";
+            list += std::to_string(cpus[i]);
+            if (last > i) list += "-" + std::to_string(cpus[last]);
+            i = last;
+        }
+        return list;
+    }
+
+#ifdef __linux__
+    int set_fifo(const int priority) {
+        const sched_param param {.sched_priority = priority};
+        return pthread_setschedparam(pthread_self(), SCHED_FIFO, &param);
+    }
+#endif
+}
+
+std::vector<int> ThreadPolicy::parse_cpus(const std::string &list) {
+    const auto number = [&list](const std::string &text) {
+        try {
+            size_t used = 0;
+            const int value = std::stoi(text, &used);
+            if (used == text.size() && value >= 0) return value;
+        } catch (const std::exception&) {}
+        throw std::runtime_error("Bad CPU '" + text + "' in '" + list + "'");
+    };
+
+    std::vector<int> cpus;
+    size_t begin = 0;
+    while (begin <= list.size()) {
+        const size_t end = std::min(list.find(',', begin), list.size());
+        const std::string range = list.substr(begin, end - begin);
+        begin = end + 1;
+
+        const size_t dash = range.find('-');
+        const int first = number(range.substr(0, dash));
+        const int last = dash == std::string::npos ? first : number(range.substr(dash + 1));
+        if (last < first) throw std::runtime_error("Bad CPU range '" + range + "' in '" + list + "'");
+        for (int cpu = first; cpu <= last; cpu++) cpus.push_back(cpu);
+    }
+    std::sort(cpus.begin(), cpus.end());
+    cpus.erase(std::unique(cpus.begin(), cpus.end()), cpus.end());
+    return cpus;
+}
+
+ThreadTuning::Deferred::Deferred(const char *role, ThreadPolicy policy) : m_role(role), m_policy(std::move(policy)) {
+    std::lock_guard<std::mutex> guard(report_mutex);
+    deferred_tunings.push_back(this);
+}
+
+ThreadTuning::Deferred::~Deferred() {
+    std::lock_guard<std::mutex> guard(report_mutex);
+    collect(*this);
+    std::erase(deferred_tunings, this);
+}
+
+void ThreadTuning::Deferred::apply() {
+    if (m_applied || m_policy.is_default()) return;
+    m_applied = true;
+    m_outcome = tune(m_policy);
+    m_ready.store(true, std::memory_order_release);
+}
+
+void ThreadTuning::apply(const char *role, const ThreadPolicy &policy) {
+    report(std::string(role) + " thread", describe(policy, tune(policy)));
+}
+
+ThreadTuning::Outcome ThreadTuning::tune(const ThreadPolicy &policy) {
+    Outcome outcome;
+#ifdef __linux__
+    if (!policy.cpus.empty()) {
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        for (const int cpu : policy.cpus) {
+            if (cpu < CPU_SETSIZE) CPU_SET(cpu, &set);
+        }
+        outcome.affinity_error = pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+    }
+    if (policy.realtime_priority > 0) {
+        int err = set_fifo(policy.realtime_priority);
+        // A soft rtprio limit below the hard one is ours to raise
+        rlimit limit {};
+        if (err == EPERM && getrlimit(RLIMIT_RTPRIO, &limit) == 0 &&
+            limit.rlim_cur < static_cast<rlim_t>(policy.realtime_priority) &&
+            (limit.rlim_max == RLIM_INFINITY || limit.rlim_max >= static_cast<rlim_t>(policy.realtime_priority))) {
+            limit.rlim_cur = static_cast<rlim_t>(policy.realtime_priority);
+            if (setrlimit(RLIMIT_RTPRIO, &limit) == 0) err = set_fifo(policy.realtime_priority);
+        }
+        outcome.priority_error = err;
+    }
+
+    // What the kernel says we have, which is not necessarily what was asked for
+    int scheduler = SCHED_OTHER;
+    sched_param param {};
+    pthread_getschedparam(pthread_self(), &scheduler, &param);
+    outcome.scheduler = scheduler;
+    outcome.priority = param.sched_priority;
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    if (pthread_getaffinity_np(pthread_self(), sizeof(set), &set) == 0) {
+        outcome.cpus_known = true;
+        for (int cpu = 0; cpu < std::min<int>(CPU_SETSIZE, outcome.cpus.size() * 64); cpu++) {
+            if (CPU_ISSET(cpu, &set)) outcome.cpus[cpu / 64] |= uint64_t(1) << (cpu % 64);
+        }
+    }
+#endif
+    return outcome;
+}
+
+std::string ThreadTuning::describe(const ThreadPolicy &policy, const Outcome &outcome) {
+    std::string line;
+#ifdef __linux__
+    switch (outcome.scheduler) {
+        case SCHED_FIFO: line += "SCHED_FIFO priority " + std::to_string(outcome.priority); break;
+        case SCHED_RR: line += "SCHED_RR priority " + std::to_string(outcome.priority); break;
+        case SCHED_BATCH: line += "SCHED_BATCH"; break;
+        case SCHED_IDLE: line += "SCHED_IDLE"; break;
+        default: line += "SCHED_OTHER"; break;
+    }
+    if (outcome.cpus_known) {
+        std::vector<int> cpus;
+        for (int cpu = 0; cpu < static_cast<int>(outcome.cpus.size() * 64); cpu++) {
+            if (outcome.cpus[cpu / 64] >> (cpu % 64) & 1) cpus.push_back(cpu);
+        }
+        line += ", CPUs " + cpu_list(cpus);
+    }
+    if (outcome.affinity_error != 0) {
+        line += ", CPUs " + cpu_list(policy.cpus) + " refused: " + std::strerror(outcome.affinity_error);
+    }
+    if (outcome.priority_error != 0) {
+        line += ", SCHED_FIFO " + std::to_string(policy.realtime_priority) + " refused: " +
+                std::strerror(outcome.priority_error) +
+                (outcome.priority_error == EPERM ? " (needs CAP_SYS_NICE or an rtprio limit)" : "");
+    }
+#else
+    (void)outcome;
+    line += policy.is_default() ? "default scheduling" : "scheduling and affinity not supported on this platform";
+#endif
+    return line;
+}
+
+void ThreadTuning::collect(Deferred &deferred) {
+    if (deferred.m_reported || !deferred.m_ready.load(std::memory_order_acquire)) return;
+    deferred.m_reported = true;
+    add_line(std::string(deferred.m_role) + " thread", describe(deferred.m_policy, deferred.m_outcome));
+}
+
+bool ThreadTuning::lock_memory(const char *what, const std::span<const std::byte> memory) {
+    const std::string size = std::to_string((memory.size() + 1023) / 1024) + " KiB";
+    if (mlock(memory.data(), memory.size()) == 0) {
+        report(what, size + " locked in memory");
+        return true;
+    }
+    const int err = errno;
+    std::string line = size + " not locked: " + std::strerror(err);
+    rlimit limit {};
+    if (getrlimit(RLIMIT_MEMLOCK, &limit) == 0 && limit.rlim_cur != RLIM_INFINITY) {
+        line += " (RLIMIT_MEMLOCK " + std::to_string(limit.rlim_cur / 1024) + " KiB)";
+    }
+    report(what, line);
+    return false;
+}
+
+void ThreadTuning::print_report(std::ostream &out) {
+    std::lock_guard<std::mutex> guard(report_mutex);
+    for (Deferred *deferred : deferred_tunings) collect(*deferred);
+    for (const auto &[subject, outcome] : report_lines) {
+        out << subject << ": " << outcome << "\n";
+    }
+    out.flush();
+}
\ No newline at end of file
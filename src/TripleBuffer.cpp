@@ -0,0 +1,5 @@
+//
+// Created by Sebastian Sandstig on 2026-10-17.
+//
+
+#include <TripleBuffer.h>
\ No newline at end of file
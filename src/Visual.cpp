@@ -199,6 +199,7 @@ Visual::Visual(size_t max_frames_in_flight) : m_max_frames_in_flight(max_frames_
         m_image_available_semaphores.resize(m_max_frames_in_flight);
         m_render_finished_semaphores.resize(m_max_frames_in_flight);
         m_in_flight_fences.resize(m_max_frames_in_flight);
+        m_submit_times.resize(m_max_frames_in_flight);
 
         VkSemaphoreCreateInfo semaphore_info{};
         semaphore_info.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
@@ -245,6 +246,7 @@ Visual::Visual(size_t max_frames_in_flight) : m_max_frames_in_flight(max_frames_
 
 void Visual::run(InterFrame* inter_frame) {
     // size_t i = 0;
+    m_inter_frame = inter_frame;
     while (!glfwWindowShouldClose(m_window)) {
         glfwPollEvents();
         inter_frame->inter_frame();
@@ -252,6 +254,7 @@ void Visual::run(InterFrame* inter_frame) {
     }
 
     vkDeviceWaitIdle(m_device->logical_device_handle());
+    m_inter_frame = nullptr;
 }
 
 void Visual::load_sprites(std::map<const char*, SpriteKind> &sprites) {
@@ -360,6 +363,12 @@ void Visual::load_sprites(std::map<const char*, SpriteKind> &sprites) {
 
 void Visual::draw_frame() {
     vkWaitForFences(m_device->logical_device_handle(), 1, &m_in_flight_fences[m_current_frame], VK_TRUE, UINT64_MAX);
+    if (m_submit_times[m_current_frame] != std::chrono::steady_clock::time_point{}) {
+        if (m_inter_frame != nullptr) {
+            m_inter_frame->frame_completed(m_submit_times[m_current_frame], std::chrono::steady_clock::now());
+        }
+        m_submit_times[m_current_frame] = {};
+    }
 
     uint32_t imageIndex;
     VkResult result = vkAcquireNextImageKHR(m_device->logical_device_handle(),
@@ -402,6 +411,8 @@ void Visual::draw_frame() {
     if (vkQueueSubmit(graphics_queue, 1, &submitInfo, m_in_flight_fences[m_current_frame]) != VK_SUCCESS) {
         throw std::runtime_error("failed to submit draw command buffer!");
     }
+    const auto submitted = std::chrono::steady_clock::now();
+    m_submit_times[m_current_frame] = submitted;
 
     VkPresentInfoKHR presentInfo{};
     presentInfo.sType = VK_STRUCTURE_TYPE_PRESENT_INFO_KHR;
@@ -417,6 +428,9 @@ void Visual::draw_frame() {
 
     VkQueue present_queue = m_device->queue(PRESENTATION).value();
     result = vkQueuePresentKHR(present_queue, &presentInfo);
+    if (m_inter_frame != nullptr) {
+        m_inter_frame->frame_presented(submitted, std::chrono::steady_clock::now());
+    }
     if (result == VK_ERROR_OUT_OF_DATE_KHR || result == VK_SUBOPTIMAL_KHR || m_framebuffer_resized) {
         m_framebuffer_resized = false;
         m_render_target->recreate_swap_chain();
@@ -0,0 +1,84 @@
+//
+// Created by Sebastian Sandstig on 2026-10-17.
+//
+
+#include <WavReader.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+
+#include <PcmFormat.h>
+
+namespace {
+    constexpr uint16_t FORMAT_PCM = 1;
+    constexpr uint16_t FORMAT_FLOAT = 3;
+    constexpr uint16_t FORMAT_EXTENSIBLE = 0xFFFE;
+
+    // WAVE is little endian whatever the host is
+    uint32_t read_u32(const uint8_t *p) {
+        return p[0] | (p[1] << 8) | (p[2] << 16) | (static_cast<uint32_t>(p[3]) << 24);
+    }
+    uint16_t read_u16(const uint8_t *p) {
+        return static_cast<uint16_t>(p[0] | (p[1] << 8));
+    }
+}
+
+WavReader::WavReader(const std::string &path) {
+    std::ifstream file(path, std::ios::binary | std::ios::ate);
+    if (!file) {
+        throw std::runtime_error("WavReader: cannot open " + path);
+    }
+    std::vector<uint8_t> bytes(static_cast<size_t>(file.tellg()));
+    file.seekg(0);
+    file.read(reinterpret_cast<char *>(bytes.data()), static_cast<std::streamsize>(bytes.size()));
+    if (bytes.size() < 12 || std::memcmp(bytes.data(), "RIFF", 4) != 0 || std::memcmp(bytes.data() + 8, "WAVE", 4) != 0) {
+        throw std::runtime_error("WavReader: " + path + " is not a RIFF/WAVE file");
+    }
+
+    uint16_t format = 0;
+    size_t block_align = 0;
+    const uint8_t *data = nullptr;
+    size_t data_size = 0;
+    for (size_t pos = 12; pos + 8 <= bytes.size();) {
+        const uint8_t *chunk = bytes.data() + pos;
+        const size_t size = read_u32(chunk + 4);
+        const size_t available = std::min(size, bytes.size() - pos - 8);
+        if (std::memcmp(chunk, "fmt ", 4) == 0 && available >= 16) {
+            format = read_u16(chunk + 8);
+            m_channel_count = read_u16(chunk + 10);
+            m_sample_rate = read_u32(chunk + 12);
+            block_align = read_u16(chunk + 20);
+            m_bits_per_sample = read_u16(chunk + 22);
+            if (format == FORMAT_EXTENSIBLE && available >= 26) {
+                // The real format is the first two bytes of the sub-format GUID
+                format = read_u16(chunk + 32);
+            }
+        } else if (std::memcmp(chunk, "data", 4) == 0) {
+            data = chunk + 8;
+            data_size = available;     // Streams that never patched the size still decode what is there
+        }
+        pos += 8 + size + (size & 1);  // Chunks are padded to even sizes
+    }
+
+    if (data == nullptr || m_channel_count == 0 || m_sample_rate == 0) {
+        throw std::runtime_error("WavReader: " + path + " has no fmt or data chunk");
+    }
+    const bool supported = (format == FORMAT_PCM && (m_bits_per_sample == 8 || m_bits_per_sample == 16 ||
+                                                     m_bits_per_sample == 24 || m_bits_per_sample == 32)) ||
+                           (format == FORMAT_FLOAT && (m_bits_per_sample == 32 || m_bits_per_sample == 64));
+    const size_t bytes_per_sample = m_bits_per_sample / 8;
+    if (!supported || block_align < bytes_per_sample * m_channel_count) {
+        throw std::runtime_error("WavReader: unsupported sample format in " + path);
+    }
+
+    const auto encoding = format == FORMAT_FLOAT ? (m_bits_per_sample == 32 ? PcmFormat::F32 : PcmFormat::F64) :
+                          m_bits_per_sample == 8 ? PcmFormat::U8 :          // 8-bit WAVE is unsigned
+                          m_bits_per_sample == 16 ? PcmFormat::S16 :
+                          m_bits_per_sample == 24 ? PcmFormat::S24 : PcmFormat::S32;
+    const PcmFormat pcm {.encoding = encoding, .channel_count = m_channel_count};
+    m_samples.resize(data_size / block_align);
+    pcm.decode(data, m_samples.size(), m_samples.data(), block_align);
+}
@@ -9,55 +9,27 @@
 #include <iostream>
 #include <string>
 #include <communication/content_download.h>
-#include <curl/curl.h>
+#include <communication/http_client.h>
 // #define STB_IMAGE_IMPLEMENTATION
 // #include <stb_image.h>
 // #include <vibra/communication/shazam.h>
 // #include <vibra/communication/timezones.h>
 // #include <vibra/communication/user_agents.h>
 
-// COPIED FROM VIBRA: https://github.com/BayernMuller/vibra
-std::size_t write_callback(void *contents, size_t size, size_t nmemb, void *userp)
-{
-    std::string *buffer = reinterpret_cast<std::string *>(userp);
-    std::size_t realsize = size * nmemb;
-    buffer->append(reinterpret_cast<char *>(contents), realsize);
-    return realsize;
-}
 // PARTS COPIED FROM VIBRA: https://github.com/BayernMuller/vibra
 std::string Communication::load_cover_art(const std::string &url) {
-    CURL *curl = curl_easy_init();
-    std::string buffer;
-
-    if (curl == nullptr) throw std::runtime_error("curl_easy_init() failed");
-
-    struct curl_slist *headers = nullptr;
-    headers = curl_slist_append(headers, "Accept-Encoding: gzip, deflate, br");
-    headers = curl_slist_append(headers, "Accept: */*");
-    headers = curl_slist_append(headers, "Connection: keep-alive");
-    headers = curl_slist_append(headers, "Content-Type: application/json");
-    headers = curl_slist_append(headers, "Content-Language: en_US");
-    curl_easy_setopt(curl, CURLOPT_URL, url.c_str());
-    curl_easy_setopt(curl, CURLOPT_HTTPHEADER, headers);
-    curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, write_callback);
-    curl_easy_setopt(curl, CURLOPT_WRITEDATA, &buffer);
-
-    CURLcode res = curl_easy_perform(curl);
-    if (res != CURLE_OK)
+    // Usually right after the recognition request, on the same client and its warm DNS and TLS caches
+    auto response = HttpClient::shared().perform({.url = url});
+    if (!response.error.empty())
     {
-        std::cerr << "curl_easy_perform() failed: " << curl_easy_strerror(res) << std::endl;
+        std::cerr << "curl_easy_perform() failed: " << response.error << std::endl;
     }
-
-    std::int64_t http_code = 0;
-    curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &http_code);
-    if (http_code != 200)
+    if (response.status != 200)
     {
-        std::cerr << "HTTP code: " << http_code << std::endl;
+        std::cerr << "HTTP code: " << response.status << std::endl;
     }
-    curl_slist_free_all(headers);
-    curl_easy_cleanup(curl);
 
-    return buffer;
+    return response.body;
 }
 
 
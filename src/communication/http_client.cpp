@@ -0,0 +1,135 @@
+//
+// Created by Sebastian Sandstig on 2026-10-17.
+//
+
+#include <communication/http_client.h>
+
+namespace {
+    std::size_t append_body(void *contents, const size_t size, const size_t nmemb, void *userp) {
+        auto *buffer = static_cast<std::string *>(userp);
+        buffer->append(static_cast<char *>(contents), size * nmemb);
+        return size * nmemb;
+    }
+
+    int check_cancel(void *clientp, curl_off_t, curl_off_t, curl_off_t, curl_off_t) {
+        const auto *cancel = static_cast<const std::atomic<bool> *>(clientp);
+        return cancel->load(std::memory_order_relaxed) ? 1 : 0;
+    }
+}
+
+namespace Communication {
+
+HttpClient& HttpClient::shared() {
+    // Never destroyed: a cover art download may still be running on its own thread while statics are torn down
+    static HttpClient *client = new HttpClient();
+    return *client;
+}
+
+HttpClient::HttpClient() : m_share(nullptr), m_headers(nullptr) {
+    // Failures here surface as failed requests, like a failed curl_easy_init did before; without a share every
+    // handle just keeps its own caches
+    curl_global_init(CURL_GLOBAL_DEFAULT);
+    m_share = curl_share_init();
+    if (m_share != nullptr) {
+        curl_share_setopt(m_share, CURLSHOPT_LOCKFUNC, lock_share);
+        curl_share_setopt(m_share, CURLSHOPT_UNLOCKFUNC, unlock_share);
+        curl_share_setopt(m_share, CURLSHOPT_USERDATA, this);
+        // Not CURL_LOCK_DATA_CONNECT: libcurl does not support sharing connections between threads, the pooled
+        // handles keep them instead
+        curl_share_setopt(m_share, CURLSHOPT_SHARE, CURL_LOCK_DATA_DNS);
+        curl_share_setopt(m_share, CURLSHOPT_SHARE, CURL_LOCK_DATA_SSL_SESSION);
+    }
+
+    for (const char *header : {"Accept-Encoding: gzip, deflate, br", "Accept: */*", "Connection: keep-alive",
+                               "Content-Type: application/json", "Content-Language: en_US"}) {
+        m_headers = curl_slist_append(m_headers, header);
+    }
+}
+
+HttpClient::Response HttpClient::perform(const Request &request) {
+    Response response;
+    CURL *curl = acquire();
+    if (curl == nullptr) {
+        response.error = "curl_easy_init() failed";
+        return response;
+    }
+
+    curl_easy_setopt(curl, CURLOPT_SHARE, m_share);
+    curl_easy_setopt(curl, CURLOPT_URL, request.url.c_str());
+    curl_easy_setopt(curl, CURLOPT_HTTPHEADER, m_headers);
+    curl_easy_setopt(curl, CURLOPT_HTTP_VERSION, CURL_HTTP_VERSION_1_1);
+    curl_easy_setopt(curl, CURLOPT_TCP_KEEPALIVE, 1L);
+    curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, append_body);
+    curl_easy_setopt(curl, CURLOPT_WRITEDATA, &response.body);
+    if (request.post_fields != nullptr) {
+        curl_easy_setopt(curl, CURLOPT_POST, 1L);
+        curl_easy_setopt(curl, CURLOPT_POSTFIELDS, request.post_fields->c_str());
+        curl_easy_setopt(curl, CURLOPT_POSTFIELDSIZE_LARGE, static_cast<curl_off_t>(request.post_fields->size()));
+    }
+    if (request.user_agent != nullptr) curl_easy_setopt(curl, CURLOPT_USERAGENT, request.user_agent);
+    if (request.decode) curl_easy_setopt(curl, CURLOPT_ACCEPT_ENCODING, "gzip, deflate, br");
+    if (request.cancel != nullptr) {
+        curl_easy_setopt(curl, CURLOPT_XFERINFOFUNCTION, check_cancel);
+        curl_easy_setopt(curl, CURLOPT_XFERINFODATA, request.cancel);
+        curl_easy_setopt(curl, CURLOPT_NOPROGRESS, 0L);
+    }
+
+    const CURLcode result = curl_easy_perform(curl);
+    if (result == CURLE_ABORTED_BY_CALLBACK) {
+        response.aborted = true;
+        response.body.clear();
+    } else if (result != CURLE_OK) {
+        response.error = curl_easy_strerror(result);
+    }
+    long status = 0;
+    curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &status);
+    response.status = status;
+    long connects = 0;
+    curl_easy_getinfo(curl, CURLINFO_NUM_CONNECTS, &connects);
+    m_requests.fetch_add(1, std::memory_order_relaxed);
+    m_connections.fetch_add(static_cast<uint64_t>(connects), std::memory_order_relaxed);
+
+    release(curl);
+    return response;
+}
+
+HttpClient::Counters HttpClient::counters() const {
+    return Counters {
+        .requests = m_requests.load(std::memory_order_relaxed),
+        .connections = m_connections.load(std::memory_order_relaxed),
+    };
+}
+
+void HttpClient::print(std::ostream &out) const {
+    const auto counters = this->counters();
+    out << "http: " << counters.requests << " requests, " << counters.connections << " new connections" << std::endl;
+}
+
+CURL *HttpClient::acquire() {
+    {
+        std::lock_guard<std::mutex> guard(m_pool_mutex);
+        if (!m_idle.empty()) {
+            CURL *curl = m_idle.back();
+            m_idle.pop_back();
+            return curl;
+        }
+    }
+    return curl_easy_init();
+}
+
+void HttpClient::release(CURL *handle) {
+    // Clears the options of the last request but keeps its connections, see curl_easy_reset
+    curl_easy_reset(handle);
+    std::lock_guard<std::mutex> guard(m_pool_mutex);
+    m_idle.push_back(handle);
+}
+
+void HttpClient::lock_share(CURL *, const curl_lock_data data, curl_lock_access, void *client) {
+    static_cast<HttpClient *>(client)->m_share_locks[data].lock();
+}
+
+void HttpClient::unlock_share(CURL *, const curl_lock_data data, void *client) {
+    static_cast<HttpClient *>(client)->m_share_locks[data].unlock();
+}
+
+}
\ No newline at end of file
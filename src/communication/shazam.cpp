@@ -2,7 +2,8 @@
 // Author: Jayden "BayernMuller" https://github.com/BayernMuller
 
 #include <vibra/communication/shazam.h>
-#include <curl/curl.h>
+#include <communication/http_client.h>
+#include <iostream>
 #include <algorithm>
 #include <random>
 #include <sstream>
@@ -14,58 +15,32 @@
 // static variables initialization
 constexpr char Shazam::HOST[];
 
-std::size_t writeCallback(void *contents, size_t size, size_t nmemb, void *userp)
-{
-    std::string *buffer = reinterpret_cast<std::string *>(userp);
-    std::size_t realsize = size * nmemb;
-    buffer->append(reinterpret_cast<char *>(contents), realsize);
-    return realsize;
-}
-
-std::string Shazam::Recognize(const Fingerprint *fingerprint)
+std::string Shazam::Recognize(const Fingerprint *fingerprint, const std::atomic<bool> *cancel)
 {
     auto content = getRequestContent(fingerprint->uri, fingerprint->sample_ms);
     auto user_agent = getUserAgent();
-    std::string url = getShazamHost();
 
-    CURL *curl = curl_easy_init();
-    std::string read_buffer;
-
-    if (curl)
+    // Rides the connections and TLS sessions of earlier requests, see HttpClient
+    auto response = Communication::HttpClient::shared().perform({
+        .url = getShazamHost(),
+        .post_fields = &content,
+        .user_agent = user_agent.c_str(),
+        .decode = true,
+        .cancel = cancel,
+    });
+    if (response.aborted)
     {
-        struct curl_slist *headers = nullptr;
-        headers = curl_slist_append(headers, "Accept-Encoding: gzip, deflate, br");
-        headers = curl_slist_append(headers, "Accept: */*");
-        headers = curl_slist_append(headers, "Connection: keep-alive");
-        headers = curl_slist_append(headers, "Content-Type: application/json");
-        headers = curl_slist_append(headers, "Content-Language: en_US");
-        curl_easy_setopt(curl, CURLOPT_URL, url.c_str());
-        curl_easy_setopt(curl, CURLOPT_POST, 1L);
-        curl_easy_setopt(curl, CURLOPT_USERAGENT, user_agent.c_str());
-        curl_easy_setopt(curl, CURLOPT_POSTFIELDS, content.c_str());
-        curl_easy_setopt(curl, CURLOPT_HTTPHEADER, headers);
-        curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, writeCallback);
-        curl_easy_setopt(curl, CURLOPT_WRITEDATA, &read_buffer);
-
-        curl_easy_setopt(curl, CURLOPT_ACCEPT_ENCODING, "gzip, deflate, br");
-        curl_easy_setopt(curl, CURLOPT_HTTP_VERSION, CURL_HTTP_VERSION_1_1);
-
-        CURLcode res = curl_easy_perform(curl);
-        if (res != CURLE_OK)
-        {
-            std::cerr << "curl_easy_perform() failed: " << curl_easy_strerror(res) << std::endl;
-        }
-
-        std::int64_t http_code = 0;
-        curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &http_code);
-        if (http_code != 200)
-        {
-            std::cerr << "HTTP code: " << http_code << std::endl;
-        }
-        curl_slist_free_all(headers);
-        curl_easy_cleanup(curl);
+        return response.body;
+    }
+    if (!response.error.empty())
+    {
+        std::cerr << "curl_easy_perform() failed: " << response.error << std::endl;
+    }
+    if (response.status != 200)
+    {
+        std::cerr << "HTTP code: " << response.status << std::endl;
     }
-    return read_buffer;
+    return response.body;
 }
 
 std::string Shazam::getShazamHost()
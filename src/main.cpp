@@ -1,13 +1,24 @@
+#include <algorithm>
 #include <atomic>
 #include <chrono>
+#include <cmath>
 #include <cstdlib>
 #include <future>
 #include <iostream>
 #include <queue>
+#include <thread>
 
 #include <AudioRecord.h>
+#include <AudioSource.h>
 #include <CoverArt.h>
+#include <DspBench.h>
+#include <OfflineSpectrogram.h>
+#include <PipelineLatency.h>
+#include <Resampler.h>
+#include <ThreadTuning.h>
 #include <Visual.h>
+#include <WavReader.h>
+#include <communication/http_client.h>
 
 #define GLM_FORCE_RADIANS
 #define GLM_FORCE_DEPTH_ZERO_TO_ONE
@@ -17,6 +28,13 @@
 #define STB_IMAGE_IMPLEMENTATION
 #include <stb_image.h>
 
+// Producer counters next to what the analysis lost: overflows and long gaps point at the callback, lost samples
+// with a healthy callback at the analysis thread
+void print_capture_report(const AudioRecord &audio_record, std::ostream &out) {
+    audio_record.capture_stats().print(out);
+    out << "analysis lost " << audio_record.analysis_lost_samples() << " samples" << std::endl;
+}
+
 void printEnv(const char* var) {
     const char* value = std::getenv(var);
     if (value) {
@@ -28,12 +46,42 @@ void printEnv(const char* var) {
 
 class Application : public InterFrame {
 public:
-    explicit Application(Visual *vis) : InterFrame(), m_vis(vis), m_amplitude(m_bar_count)
+    Application(Visual *vis, std::unique_ptr<AudioSource> source, const ThreadTuningSettings &threads) : InterFrame(),
+        m_vis(vis), m_amplitude(m_bar_count), m_render_thread_policy(threads.render)
 
     {
         m_bone_displacement.resize(m_bar_count);
         m_image_count = vis->get_image_count();
-        m_audio_record = new AudioRecord(32768);
+        // SOUNDSCAPE_SPECTRUM_ENGINE=radix2|radix4|fftw to A/B the FFT backends
+        const char* engine_name = std::getenv("SOUNDSCAPE_SPECTRUM_ENGINE");
+        const auto engine = engine_name != nullptr ? SpectrumEngine::parse_kind(engine_name) : std::nullopt;
+        // SOUNDSCAPE_BAND_SCALE=mel|log|cq picks how the bars are spaced
+        const char* band_scale_name = std::getenv("SOUNDSCAPE_BAND_SCALE");
+        const auto band_scale = band_scale_name != nullptr ? BandMapper::parse_scale(band_scale_name) : std::nullopt;
+        // SOUNDSCAPE_RECOGNITION_CACHE=PATH moves the file of recognised tracks, an empty value disables it
+        const char* recognition_cache = std::getenv("SOUNDSCAPE_RECOGNITION_CACHE");
+        m_audio_record = new AudioRecord(AudioRecordSettings {
+            .analysis_rate = 24000,
+            .fft_size = 8192,
+            .hop_size = 512,
+            .spectrum_engine = engine.value_or(SpectrumEngine::DEFAULT_KIND),
+            .window = Stft::HANN,
+            .band_count = m_bar_count,
+            .band_low_frequency = 30.0f,
+            .band_high_frequency = 10000.0f,
+            .band_scale = band_scale.value_or(BandMapper::MEL),
+            .threads = threads,
+            .recognition_cache_path = recognition_cache != nullptr ? recognition_cache
+                                                                   : RecognitionCache::default_path(),
+        }, std::move(source));
+        std::cout << "Audio source: " << m_audio_record->source().name() << " at " << m_audio_record->sample_rate()
+                  << " Hz" << std::endl;
+        std::cout << "Spectrum engine: " << SpectrumEngine::kind_name(m_audio_record->spectrum_engine()) << std::endl;
+        // SOUNDSCAPE_LATENCY_REPORT=SECONDS prints the audio-to-present latency breakdown that often
+        if (const char* report_interval = std::getenv("SOUNDSCAPE_LATENCY_REPORT")) {
+            m_latency_report_interval = std::chrono::duration<double>(std::atof(report_interval));
+        }
+        m_last_latency_report = std::chrono::steady_clock::now();
 
         m_last_frame = std::chrono::steady_clock::now();
 
@@ -49,6 +97,13 @@ public:
         m_cover_art->acquire_default(m_cover_art_pixels, glm::vec3(1.0f));
     }
     ~Application() override {
+        if (m_latency.histogram(PipelineLatency::TOTAL).count() > 0) {
+            m_latency.print(std::cout);
+            print_capture_report(*m_audio_record, std::cout);
+        }
+        m_audio_record->stop_recognition();
+        m_audio_record->recognition_cache().print(std::cout);
+        Communication::HttpClient::shared().print(std::cout);
         delete m_audio_record;
         delete m_cover_art;
     }
@@ -57,6 +112,8 @@ public:
         if (!m_audio_record->start_recording()) {
             throw std::runtime_error("Failed to start audio recording");
         }
+        // Last, so the threads started from here do not inherit the render thread's CPUs
+        ThreadTuning::apply("render", m_render_thread_policy);
     }
 
     void load_scene() const {
@@ -150,35 +207,36 @@ public:
 
         }
 
-        const size_t first_frequency = 30;
-        const size_t last_frequency = 10000;
-        const size_t frequency_count = last_frequency - first_frequency;
-        const auto current_frequencies = m_audio_record->current_frequencies();
-        const size_t bin_count = m_bar_count;
-        size_t frequencies_per_bin = frequency_count / bin_count;
+        // Band energies arrive ready-made from the analysis thread, this only reads the latest frame
+        const auto& analysis = m_audio_record->latest_analysis();
+        const bool new_audio = analysis.sequence != m_last_sequence;
+        if (new_audio) {
+            // The first frame means the source and the analysis thread are running and have tuned themselves
+            if (m_last_sequence == 0) ThreadTuning::print_report(std::cout);
+            m_last_sequence = analysis.sequence;
+            m_capture_time = analysis.capture_time;
+            // Sources that cannot stamp their blocks leave the capture time at the epoch
+            if (m_capture_time != std::chrono::steady_clock::time_point{}) {
+                m_latency.record(PipelineLatency::CAPTURE, analysis.pickup_time - m_capture_time);
+            }
+            m_latency.record(PipelineLatency::ANALYSIS, analysis.publish_time - analysis.pickup_time);
+        }
         std::vector<float> amps(m_bar_count);
+        for (size_t bin = 0; bin < std::min(m_bar_count, analysis.band_energies.size()); bin++) {
+            amps[bin] = analysis.band_energies[bin];
+            // Magnitudes are normalised (full-scale sine ~ 1), show the top 60 dB
+            amps[bin] = std::clamp((20.0f * std::log10(amps[bin] + 1e-9f) + 60.0f) / 60.0f, 0.0f, 1.0f);
+        }
 
-
-
-        for (size_t bin = 0; bin < bin_count; bin++) {
-            float avg_amp = 0.0f;
-            float max_amp = 0.0f;
-            for (size_t i = 0; i < frequencies_per_bin; i++) {
-                float camp = current_frequencies[bin * frequencies_per_bin + i + first_frequency];
-                if (camp > max_amp) {
-                    max_amp = camp;
-                }
-                avg_amp += camp;
-            }
-            amps[bin] = avg_amp / static_cast<float>(frequencies_per_bin);
-            if (bin == 0) amps[bin] /= 2.0f;
-            amps[bin] = 1.0f - glm::exp(-0.5*amps[bin]);
-            // amps[bin] /= 5.0f;
-            // amps[bin] = max_amp;
-            // if (bin == 0) {
-            //     amps[bin] /= 4.0f;
-            // }
+        // Kick the bars on every tracked beat; frames can be skipped, so compare counters rather than a flag
+        if (analysis.beat.beat_count != m_last_beat_count) {
+            m_last_beat_count = analysis.beat.beat_count;
+            m_beat_pulse = 1.0f;
+        }
+        for (auto &amp : amps) {
+            amp = std::min(amp * (1.0f + 0.15f * m_beat_pulse), 1.0f);
         }
+        m_beat_pulse *= 0.85f;
 
         for (size_t i = 0; i < m_bar_count; i++) {
             m_amplitude[i] += 0.3f * (amps[i] - m_amplitude[i]);
@@ -191,6 +249,11 @@ public:
                 sp->set_buffer(j, 2, &bone_buffer, sizeof(BoneBuffer));
             }
         }
+        if (new_audio) {
+            m_update_time = std::chrono::steady_clock::now();
+            m_latency.record(PipelineLatency::UPDATE, m_update_time - analysis.publish_time);
+            m_awaiting_present = true;
+        }
 
         // auto camera = m_vis->get_camera();
         // auto data = camera->get_data();
@@ -206,6 +269,29 @@ public:
         m_last_frame = std::chrono::steady_clock::now();
     }
 
+    void frame_presented(const std::chrono::steady_clock::time_point submitted,
+                         const std::chrono::steady_clock::time_point presented) override {
+        if (m_awaiting_present) {
+            m_awaiting_present = false;
+            m_latency.record(PipelineLatency::PRESENT, presented - m_update_time);
+            if (m_capture_time != std::chrono::steady_clock::time_point{}) {
+                m_latency.record(PipelineLatency::TOTAL, presented - m_capture_time);
+            }
+        }
+        if (m_latency_report_interval.count() > 0.0 && presented - m_last_latency_report >= m_latency_report_interval) {
+            m_last_latency_report = presented;
+            m_latency.print(std::cout);
+            print_capture_report(*m_audio_record, std::cout);
+        }
+    }
+
+    void frame_completed(const std::chrono::steady_clock::time_point submitted,
+                         const std::chrono::steady_clock::time_point completed) override {
+        m_latency.record(PipelineLatency::GPU, completed - submitted);
+    }
+
+    [[nodiscard]] const PipelineLatency& latency() const { return m_latency; }
+
 private:
     Visual* m_vis;
     size_t m_image_count;
@@ -217,8 +303,20 @@ private:
     float m_bars_width = 6;
     float m_bar_margin = 0.1 / 8;
     std::vector<float> m_amplitude;
+    uint64_t m_last_beat_count = 0;
+    float m_beat_pulse = 0.0f;
+
+    // Audio-to-present latency of the newest spectrum on screen
+    PipelineLatency m_latency;
+    uint64_t m_last_sequence = 0;
+    std::chrono::steady_clock::time_point m_capture_time;
+    std::chrono::steady_clock::time_point m_update_time;
+    bool m_awaiting_present = false;
+    std::chrono::duration<double> m_latency_report_interval {0.0};
+    std::chrono::steady_clock::time_point m_last_latency_report;
 
     AudioRecord* m_audio_record;
+    ThreadPolicy m_render_thread_policy;
     std::optional<std::string> m_last_cover_art = std::nullopt;
 
     CoverArt* m_cover_art;
@@ -232,7 +330,183 @@ private:
 };
 
 
-int main() {
+// soundscape --spectrogram <in.wav> <out.bin> [--fft N] [--hop N] [--bands N] [--rate HZ] [--threads N] [--static 0|1]
+int run_spectrogram(const int argc, char **argv) {
+    if (argc < 4) {
+        std::cerr << "Usage: " << argv[0] << " --spectrogram <in.wav> <out.bin> [--fft N] [--hop N] [--bands N]"
+                     " [--rate HZ] [--threads N] [--static 0|1]" << std::endl;
+        return EXIT_FAILURE;
+    }
+    SpectrogramSettings settings {};
+    size_t rate = 0;    // 0 keeps the file's own rate
+    for (int i = 4; i < argc; i += 2) {
+        const std::string option = argv[i];
+        if (i + 1 == argc) throw std::runtime_error("Missing value for " + option);
+        const size_t value = std::stoul(argv[i + 1]);
+        if (option == "--fft") settings.fft_size = value;
+        else if (option == "--hop") settings.hop_size = value;
+        else if (option == "--bands") settings.band_count = value;
+        else if (option == "--rate") rate = value;
+        else if (option == "--threads") settings.thread_count = value;
+        else if (option == "--static") settings.prefer_static_analyzer = value != 0;
+        else throw std::runtime_error("Unknown option " + option);
+    }
+    if (const char* engine_name = std::getenv("SOUNDSCAPE_SPECTRUM_ENGINE")) {
+        settings.spectrum_engine = SpectrumEngine::parse_kind(engine_name).value_or(settings.spectrum_engine);
+    }
+    if (const char* band_scale_name = std::getenv("SOUNDSCAPE_BAND_SCALE")) {
+        settings.band_scale = BandMapper::parse_scale(band_scale_name).value_or(settings.band_scale);
+    }
+
+    const auto start = std::chrono::steady_clock::now();
+    const WavReader wav(argv[2]);
+    std::vector<float> resampled;
+    std::span<const float> samples = wav.samples();
+    if (rate == 0) rate = wav.sample_rate();
+    if (rate != wav.sample_rate()) {
+        Resampler resampler(wav.sample_rate(), rate);
+        resampled.resize(resampler.max_output(samples.size()));
+        resampled.resize(resampler.process(samples.data(), samples.size(), resampled.data()));
+        samples = resampled;
+    }
+    const auto decoded = std::chrono::steady_clock::now();
+    const auto header = OfflineSpectrogram::render(samples, rate, argv[3], settings);
+    const auto done = std::chrono::steady_clock::now();
+
+    using ms = std::chrono::duration<double, std::milli>;
+    std::cout << argv[2] << ": " << wav.duration() << " s at " << wav.sample_rate() << " Hz, " << header.frame_count
+              << " frames of " << header.fft_size << " (" << SpectrumEngine::kind_name(settings.spectrum_engine)
+              << (settings.prefer_static_analyzer ? ", static analyzer if one matches" : "") << ") -> " << argv[3] << std::endl;
+    std::cout << "decode " << ms(decoded - start).count() << " ms, analysis " << ms(done - decoded).count() << " ms"
+              << std::endl;
+    return EXIT_SUCCESS;
+}
+
+struct CaptureOptions {
+    AudioSourceSettings source;
+    ThreadTuningSettings threads;
+};
+
+// Capture options shared by the live view and --analyze:
+//   --source portaudio|synthetic[:SIGNALS]|file:PATH|pipe:PATH|-  --rate HZ  --speed X  --loop
+//   --format u8|s16|s24|s32|f32|f64  --channels N
+// and for the threads (Linux), CPU lists like 2,3 or 0-3:
+//   --audio-priority N  --dsp-priority N (SCHED_FIFO 1-99)  --audio-cpus  --dsp-cpus  --recognition-cpus
+//   --render-cpus  --mlock (lock the capture ring and analysis buffers in memory)
+CaptureOptions parse_capture_options(const std::vector<std::string> &args) {
+    CaptureOptions options {};
+    AudioSourceSettings &settings = options.source;
+    ThreadTuningSettings &threads = options.threads;
+    const auto priority = [](const std::string &value) {
+        const int priority = std::stoi(value);
+        if (priority < 1 || priority > 99) throw std::runtime_error("SCHED_FIFO priorities go from 1 to 99");
+        return priority;
+    };
+    for (size_t i = 0; i < args.size(); i++) {
+        const std::string &option = args[i];
+        if (option == "--loop") {
+            settings.loop = true;
+            continue;
+        }
+        if (option == "--mlock") {
+            threads.lock_memory = true;
+            continue;
+        }
+        if (i + 1 == args.size()) throw std::runtime_error("Missing value for " + option);
+        const std::string &value = args[++i];
+        if (option == "--source") settings.source = value;
+        else if (option == "--rate") settings.sample_rate = std::stoul(value);
+        else if (option == "--speed") settings.speed = std::stod(value);
+        else if (option == "--channels") settings.pcm_format.channel_count = std::stoul(value);
+        else if (option == "--format") {
+            const auto encoding = PcmFormat::parse_encoding(value);
+            if (!encoding.has_value()) throw std::runtime_error("Unknown sample format " + value);
+            settings.pcm_format.encoding = *encoding;
+        }
+        else if (option == "--audio-priority") threads.audio.realtime_priority = priority(value);
+        else if (option == "--dsp-priority") threads.dsp.realtime_priority = priority(value);
+        else if (option == "--audio-cpus") threads.audio.cpus = ThreadPolicy::parse_cpus(value);
+        else if (option == "--dsp-cpus") threads.dsp.cpus = ThreadPolicy::parse_cpus(value);
+        else if (option == "--recognition-cpus") threads.recognition.cpus = ThreadPolicy::parse_cpus(value);
+        else if (option == "--render-cpus") threads.render.cpus = ThreadPolicy::parse_cpus(value);
+        else throw std::runtime_error("Unknown option " + option);
+    }
+    if (settings.pcm_format.channel_count == 0) throw std::runtime_error("--channels must be at least 1");
+    return options;
+}
+
+// soundscape --analyze [capture options]: the live analysis path without a window, e.g. to profile it on a file
+// replayed faster than real time. Runs until the source ends (or forever for endless ones) and reports throughput.
+int run_analyze(const std::vector<std::string> &args) {
+    const auto options = parse_capture_options(args);
+    AudioRecordSettings settings {};
+    settings.threads = options.threads;
+    AudioRecord audio_record(settings, AudioSource::create(options.source));
+    const auto start = std::chrono::steady_clock::now();
+    if (!audio_record.start_recording()) {
+        std::cerr << "Failed to start " << audio_record.source().name() << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    // Let the analysis drain what the source wrote last, then stop
+    uint64_t last_sequence = 0;
+    auto last_change = start;
+    while (true) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        const auto now = std::chrono::steady_clock::now();
+        if (const auto &frame = audio_record.latest_analysis(); frame.sequence != last_sequence) {
+            if (last_sequence == 0) ThreadTuning::print_report(std::cout);
+            last_sequence = frame.sequence;
+            last_change = now;
+        }
+        if (!audio_record.source().is_active() && now - last_change > std::chrono::milliseconds(200)) break;
+    }
+    const auto &frame = audio_record.latest_analysis();
+    const double wall = std::chrono::duration<double>(last_change - start).count();
+    (void)audio_record.stop_recording();
+
+    const double captured = static_cast<double>(audio_record.captured_samples()) /
+                            static_cast<double>(audio_record.sample_rate());
+    std::cout << audio_record.source().name() << ": " << frame.time << " of " << captured << " s of audio analysed in "
+              << wall << " s (" << frame.time / wall << "x real time), " << frame.sequence << " frames published, "
+              << frame.beat.tempo << " BPM" << std::endl;
+    print_capture_report(audio_record, std::cout);
+    if (audio_record.analysis_lost_samples() > 0) {
+        std::cout << "The source outran the analysis and overwrote audio before it was read, lower --speed" << std::endl;
+    }
+    return EXIT_SUCCESS;
+}
+
+int main(const int argc, char **argv) {
+    if (argc > 1 && std::string(argv[1]) == "--bench") {
+        return DspBench::run(std::vector<std::string>(argv + 2, argv + argc));
+    }
+    if (argc > 1 && std::string(argv[1]) == "--spectrogram") {
+        try {
+            return run_spectrogram(argc, argv);
+        } catch (const std::exception& e) {
+            std::cerr << e.what() << std::endl;
+            return EXIT_FAILURE;
+        }
+    }
+    if (argc > 1 && std::string(argv[1]) == "--analyze") {
+        try {
+            return run_analyze(std::vector<std::string>(argv + 2, argv + argc));
+        } catch (const std::exception& e) {
+            std::cerr << e.what() << std::endl;
+            return EXIT_FAILURE;
+        }
+    }
+    std::unique_ptr<AudioSource> source;
+    CaptureOptions options;
+    try {
+        options = parse_capture_options(std::vector<std::string>(argv + 1, argv + argc));
+        source = AudioSource::create(options.source);
+    } catch (const std::exception& e) {
+        std::cerr << e.what() << std::endl;
+        return EXIT_FAILURE;
+    }
+
     printEnv("VULKAN_SDK");
     printEnv("VK_ICD_FILENAMES");
     printEnv("VK_LAYER_PATH");
@@ -254,7 +528,7 @@ int main() {
     // camera_data.proj = glm::ortho(0, 400, 0, 400);
     camera->set_data(camera_data);
 
-    Application app(vis);
+    Application app(vis, std::move(source), options.threads);
 
     app.load_scene();
     app.start_audio_recording();
@@ -0,0 +1,10 @@
+//
+// Created by Sebastian Sandstig on 2026-10-17.
+//
+
+#include <DspBench.h>
+
+// soundscape_bench [--quick]: per-transform timings of every spectrum engine and of band mapping, 512 to 65536 points
+int main(const int argc, char **argv) {
+    return DspBench::bench(std::vector<std::string>(argv + 1, argv + argc));
+}
\ No newline at end of file
@@ -0,0 +1,10 @@
+//
+// Created by Sebastian Sandstig on 2026-10-17.
+//
+
+#include <DspBench.h>
+
+// soundscape_tests [--quick] [engines|windows|bands|ring|pipeline ...]: the DSP checks without a window or sound card
+int main(const int argc, char **argv) {
+    return DspBench::check(std::vector<std::string>(argv + 1, argv + argc));
+}
\ No newline at end of file